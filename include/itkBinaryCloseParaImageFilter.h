@@ -119,6 +119,8 @@ public:
     m_RectDilate->SetUseImageSpacing(g);
     m_CircErode->SetUseImageSpacing(g);
     m_CircDilate->SetUseImageSpacing(g);
+    m_CompactErode->SetUseImageSpacing(g);
+    m_CompactDilate->SetUseImageSpacing(g);
   }
 
   /**
@@ -135,6 +137,31 @@ public:
   itkGetConstReferenceMacro(SafeBorder, bool);
   itkBooleanMacro(SafeBorder);
 
+  /**
+   * Set/Get whether a circular closing stores its intermediates as
+   * 16-bit fixed point rather than float - default is false. The
+   * dilation scales the mask as it reads it, and the erosion
+   * thresholds the dilation as it reads it, in place, so the padded
+   * float image makes way for a padded 16-bit one.
+   * The accuracy is that of CompactIntermediates in
+   * BinaryDilateParaImageFilter and BinaryErodeParaImageFilter, for
+   * each stage: results match the float ones for radii in pixels up
+   * to about 90 in 2D and 73 in 3D.
+   */
+  itkSetMacro(CompactIntermediates, bool);
+  itkGetConstReferenceMacro(CompactIntermediates, bool);
+  itkBooleanMacro(CompactIntermediates);
+
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing.
+   * Every internal image of the mini-pipeline is counted, at the
+   * padded size when SafeBorder is on. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
+
   /** Image related type alias. */
 
   /* add in the traits here */
@@ -149,33 +176,41 @@ protected:
 
   using InternalRealImageType = typename itk::Image<InternalRealType, InputImageType::ImageDimension>;
   using InternalIntImageType = typename itk::Image<InternalIntType, InputImageType::ImageDimension>;
-  using CircErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalRealImageType>;
-  using RectErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalIntImageType>;
-  using CircDilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, InternalRealImageType>;
-  using RectDilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, InternalRealImageType>;
+  using CircDilateType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalRealImageType>;
+  using RectDilateType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalRealImageType>;
+  // the erosions threshold the dilation as they read it
+  using CircErodeType = typename itk::ParabolicErodeImageFilter<InternalRealImageType, InternalRealImageType>;
+  using RectErodeType = typename itk::ParabolicErodeImageFilter<InternalRealImageType, InternalIntImageType>;
 
-  using CCastTypeA = typename itk::GreaterEqualValImageFilter<InternalRealImageType, OutputImageType>;
-  using CCastTypeB = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CCastType = typename itk::GreaterEqualValImageFilter<InternalRealImageType, OutputImageType>;
+  using RCastType = typename itk::GreaterEqualValImageFilter<InternalIntImageType, OutputImageType>;
 
-  using RCastTypeA = typename itk::GreaterEqualValImageFilter<InternalIntImageType, OutputImageType>;
-  using RCastTypeB = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CompactDilateType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalIntImageType>;
+  using CompactErodeType = typename itk::ParabolicErodeImageFilter<InternalIntImageType, InternalIntImageType>;
+  using CompactCastType = typename itk::BinaryThresholdImageFilter<InternalIntImageType, OutputImageType>;
 
 private:
+  // the scale of the parabolic filters, and the width of the safe
+  // border, for m_Radius on an image with the given spacing
+  void
+  GetParabolicScale(const SpacingType & spacing, RadiusType & scale, SizeType & pad) const;
+
   RadiusType m_Radius;
   bool       m_Circular;
   bool       m_SafeBorder;
+  bool       m_CompactIntermediates;
 
   typename CircErodeType::Pointer  m_CircErode;
   typename CircDilateType::Pointer m_CircDilate;
-
-  typename CCastTypeA::Pointer m_CircCastA;
-  typename CCastTypeB::Pointer m_CircCastB;
+  typename CCastType::Pointer      m_CircCast;
 
   typename RectErodeType::Pointer  m_RectErode;
   typename RectDilateType::Pointer m_RectDilate;
+  typename RCastType::Pointer      m_RectCast;
 
-  typename RCastTypeA::Pointer m_RectCastA;
-  typename RCastTypeB::Pointer m_RectCastB;
+  typename CompactErodeType::Pointer  m_CompactErode;
+  typename CompactDilateType::Pointer m_CompactDilate;
+  typename CompactCastType::Pointer   m_CompactCast;
 };
 } // end namespace itk
 
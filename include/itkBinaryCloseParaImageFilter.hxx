@@ -19,10 +19,10 @@
 #define itkBinaryCloseParaImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 #include "itkParabolicErodeImageFilter.h"
 #include "itkProgressAccumulator.h"
 #include "itkCropImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkMath.h"
 
 namespace itk
@@ -34,13 +34,50 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::BinaryCloseParaImageFilte
   this->SetNumberOfRequiredInputs(1);
   this->m_CircErode = CircErodeType::New();
   this->m_CircDilate = CircDilateType::New();
-  this->m_CircCastA = CCastTypeA::New();
-  this->m_CircCastB = CCastTypeB::New();
+  this->m_CircCast = CCastType::New();
 
   this->m_RectErode = RectErodeType::New();
   this->m_RectDilate = RectDilateType::New();
-  this->m_RectCastA = RCastTypeA::New();
-  this->m_RectCastB = RCastTypeB::New();
+  this->m_RectCast = RCastType::New();
+
+  this->m_CompactErode = CompactErodeType::New();
+  this->m_CompactDilate = CompactDilateType::New();
+  this->m_CompactCast = CompactCastType::New();
+
+  // The erosions threshold the dilation as they read it, rather than
+  // in a pass of their own, and work in place on it when they can.
+  using CircRealType = typename CircErodeType::RealType;
+  this->m_CircErode->SetPrologue(ParabolicPointwise<CircRealType>(
+    [](const CircRealType v) { return v > 0 ? CircRealType(1) : CircRealType(0); }));
+  this->m_CircErode->SetValueRange(1);
+  this->m_CircErode->InPlaceOn();
+  using RectRealType = typename RectErodeType::RealType;
+  this->m_RectErode->SetPrologue(ParabolicPointwise<RectRealType>(
+    [](const RectRealType v) { return v > 0 ? RectRealType(1) : RectRealType(0); }));
+  this->m_RectErode->SetValueRange(1);
+
+  // 16-bit fixed point throughout: the dilation stores the 0/1 mask
+  // as 0/ParabolicFixedPointOne. Truncation only lowers values, so
+  // dilated values above 0 are inside.
+  using CompactRealType = typename CompactDilateType::RealType;
+  this->m_CompactDilate->SetPrologue(ParabolicPointwise<CompactRealType>(
+    [](const CompactRealType v) { return v >= 1 ? CompactRealType(ParabolicFixedPointOne) : CompactRealType(0); }));
+  this->m_CompactDilate->SetValueRange(ParabolicFixedPointOne);
+  this->m_CompactErode->SetPrologue(ParabolicPointwise<CompactRealType>(
+    [](const CompactRealType v) { return v > 0 ? CompactRealType(ParabolicFixedPointOne) : CompactRealType(0); }));
+  this->m_CompactErode->SetValueRange(ParabolicFixedPointOne);
+  this->m_CompactErode->InPlaceOn();
+
+  // Each erode and dilate stage has a single reader, so its output can
+  // go as soon as that has run. The casts are left alone: their output
+  // is grafted onto ours when there is no border to crop.
+  this->m_CircErode->ReleaseDataFlagOn();
+  this->m_CircDilate->ReleaseDataFlagOn();
+  this->m_RectErode->ReleaseDataFlagOn();
+  this->m_RectDilate->ReleaseDataFlagOn();
+  this->m_CompactErode->ReleaseDataFlagOn();
+  this->m_CompactDilate->ReleaseDataFlagOn();
+  this->m_CompactIntermediates = false;
   this->m_Circular = true;
   // Need to call this after filters are created
   this->SetUseImageSpacing(false);
@@ -57,6 +94,93 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::SetRadius(ScalarRealType
   this->SetRadius(s);
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GetParabolicScale(const SpacingType & spacing,
+                                                                         RadiusType &        scale,
+                                                                         SizeType &          pad) const
+{
+  for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+  {
+    if (this->m_RectErode->GetUseImageSpacing())
+    {
+      // radius is in mm
+      typename TInputImage::SpacingValueType tsp = spacing[P];
+      scale[P] = 0.5 * (m_Radius[P] * m_Radius[P]) + tsp * tsp;
+      pad[P] = (typename TInputImage::SizeType::SizeValueType)(itk::Math::rnd_halfinttoeven(m_Radius[P] / tsp + 1) + 1);
+    }
+    else
+    {
+      // radius is in pixels - this gives us a little bit of a margin
+      scale[P] = (0.5 * m_Radius[P] * m_Radius[P] + 1);
+      pad[P] = (typename TInputImage::SizeType::SizeValueType)(m_Radius[P] + 1);
+    }
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+BinaryCloseParaImageFilter<TInputImage, TOutputImage>::EstimateCost(const SizeType &    size,
+                                                                    const SpacingType & spacing) const
+{
+  RadiusType scale;
+  SizeType   pad;
+  this->GetParabolicScale(spacing, scale, pad);
+  if (!m_SafeBorder)
+  {
+    pad.Fill(0);
+  }
+  // the first stage adds the border, so every image up to the crop
+  // is padded
+  SizeType padded;
+  for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+  {
+    padded[P] = size[P] + 2 * pad[P];
+  }
+
+  // stand ins for the internal filters, set up as GenerateData would
+  auto stage = [&](auto para, const SizeType & inputSize, const SizeType & border) {
+    para->SetScale(scale);
+    para->SetUseImageSpacing(m_CircErode->GetUseImageSpacing());
+    para->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    para->SetBorderPad(border);
+    return para->EstimateCost(inputSize, spacing);
+  };
+  ParabolicCostEstimate cost;
+  if (m_Circular && m_CompactIntermediates)
+  {
+    // the dilation, then the erosion in place on it
+    cost += stage(CompactDilateType::New(), size, pad);
+    typename CompactErodeType::Pointer second = CompactErodeType::New();
+    second->InPlaceOn();
+    cost += stage(second, padded, SizeType::Filled(0));
+  }
+  else if (m_Circular)
+  {
+    cost += stage(CircDilateType::New(), size, pad);
+    typename CircErodeType::Pointer second = CircErodeType::New();
+    second->InPlaceOn();
+    cost += stage(second, padded, SizeType::Filled(0));
+  }
+  else
+  {
+    cost += stage(RectDilateType::New(), size, pad);
+    cost += stage(RectErodeType::New(), padded, SizeType::Filled(0));
+  }
+
+  // the threshold between the stages is part of the second, so there
+  // is one threshold to the output type, then the crop when there is
+  // a border
+  cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(padded);
+  cost.Operations += static_cast<double>(typename TInputImage::RegionType(padded).GetNumberOfPixels());
+  if (m_SafeBorder)
+  {
+    cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(size);
+    cost.Operations += static_cast<double>(typename TInputImage::RegionType(size).GetNumberOfPixels());
+  }
+  return cost;
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateData()
@@ -74,82 +198,107 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateData()
   // margin = std::min(margin, 0.00001);
   // std::cout << "Margin = " << margin << std::endl;
 
-  if (this->m_RectErode->GetUseImageSpacing())
+  RadiusType R;
+  this->GetParabolicScale(this->GetInput()->GetSpacing(), R, Pad);
+  m_RectErode->SetScale(R);
+  m_CircErode->SetScale(R);
+  m_RectDilate->SetScale(R);
+  m_CircDilate->SetScale(R);
+
+  if (m_Circular && m_CompactIntermediates)
   {
-    // radius is in mm
-    RadiusType R;
+    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+    progress->SetMiniPipelineFilter(this);
+    InputImageConstPointer inputImage;
+    inputImage = this->GetInput();
+
+    progress->RegisterInternalFilter(m_CompactDilate, 0.45f);
+    progress->RegisterInternalFilter(m_CompactErode, 0.45f);
+    progress->RegisterInternalFilter(m_CompactCast, 0.1f);
+    ParabolicShareThreadBudget(this, m_CompactDilate);
+    ParabolicShareThreadBudget(this, m_CompactErode);
+    ParabolicShareThreadBudget(this, m_CompactCast);
+
+    // 16-bit fixed point throughout: 1 is ParabolicFixedPointOne, and
+    // the scale shrinks by the same factor
+    RadiusType compactR;
     for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
     {
-      typename TInputImage::SpacingValueType tsp = this->GetInput()->GetSpacing()[P];
-      R[P] = 0.5 * (m_Radius[P] * m_Radius[P]) + tsp * tsp;
-      Pad[P] = (typename TInputImage::SizeType::SizeValueType)(itk::Math::rnd_halfinttoeven(m_Radius[P] / tsp + 1) + 1);
+      compactR[P] = R[P] / ParabolicFixedPointOne;
     }
-    m_RectErode->SetScale(R);
-    m_CircErode->SetScale(R);
-    m_RectDilate->SetScale(R);
-    m_CircDilate->SetScale(R);
-  }
-  else
-  {
-    // radius is in pixels
-    RadiusType R;
-    // this gives us a little bit of a margin
-    for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+    m_CompactErode->SetScale(compactR);
+    m_CompactDilate->SetScale(compactR);
+
+    // the first stage adds the border as it reads and scales the mask,
+    // so everything after it can work in place
+    m_CompactDilate->SetInput(inputImage);
+    m_CompactDilate->SetBorderPad(m_SafeBorder ? Pad : TInputImage::SizeType::Filled(0));
+    m_CompactDilate->SetBorderValue(0);
+
+    m_CompactErode->SetInput(m_CompactDilate->GetOutput());
+
+    // truncation lowers each value by less than one per pass, so
+    // eroded values at least ParabolicFixedPointOne - ImageDimension
+    // are inside
+    m_CompactCast->SetInput(m_CompactErode->GetOutput());
+    m_CompactCast->SetLowerThreshold(ParabolicFixedPointOne - InputImageType::ImageDimension);
+    m_CompactCast->SetInsideValue(1);
+    m_CompactCast->SetOutsideValue(0);
+
+    if (m_SafeBorder)
     {
-      R[P] = (0.5 * m_Radius[P] * m_Radius[P] + 1);
-      Pad[P] = (typename TInputImage::SizeType::SizeValueType)(m_Radius[P] + 1);
+      using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
+      typename CropType::Pointer crop = CropType::New();
+      crop->SetInput(m_CompactCast->GetOutput());
+      crop->SetUpperBoundaryCropSize(Pad);
+      crop->SetLowerBoundaryCropSize(Pad);
+      ParabolicShareThreadBudget(this, crop);
+
+      crop->GraftOutput(this->GetOutput());
+      crop->Update();
+      this->GraftOutput(crop->GetOutput());
+    }
+    else
+    {
+      m_CompactCast->GraftOutput(this->GetOutput());
+      m_CompactCast->Update();
+      this->GraftOutput(m_CompactCast->GetOutput());
     }
-    // std::cout << "no image spacing " << m_Radius << R << std::endl;
-    m_RectErode->SetScale(R);
-    m_CircErode->SetScale(R);
-    m_RectDilate->SetScale(R);
-    m_CircDilate->SetScale(R);
   }
-
-  // std::cout << "Padding " << Pad << std::endl;
-
-  if (m_Circular)
+  else if (m_Circular)
   {
     ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
     progress->SetMiniPipelineFilter(this);
     InputImageConstPointer inputImage;
     inputImage = this->GetInput();
 
-    progress->RegisterInternalFilter(m_CircErode, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastA, 0.1f);
-    progress->RegisterInternalFilter(m_CircDilate, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastB, 0.1f);
+    progress->RegisterInternalFilter(m_CircDilate, 0.45f);
+    progress->RegisterInternalFilter(m_CircErode, 0.45f);
+    progress->RegisterInternalFilter(m_CircCast, 0.1f);
+    ParabolicShareThreadBudget(this, m_CircDilate);
+    ParabolicShareThreadBudget(this, m_CircErode);
+    ParabolicShareThreadBudget(this, m_CircCast);
 
-    m_CircCastB->SetInput(m_CircDilate->GetOutput());
-    //    m_CircCastB->SetUpperThreshold(margin);
-    m_CircCastB->SetUpperThreshold(0);
-    m_CircCastB->SetOutsideValue(1);
-    m_CircCastB->SetInsideValue(0);
-
-    m_CircErode->SetInput(m_CircCastB->GetOutput());
-    m_CircCastA->SetInput(m_CircErode->GetOutput());
-    //    m_CircCastA->SetVal(1.0-margin);
-    m_CircCastA->SetVal(1.0);
+    m_CircErode->SetInput(m_CircDilate->GetOutput());
+    m_CircCast->SetInput(m_CircErode->GetOutput());
+    m_CircCast->SetVal(1.0);
 
     if (m_SafeBorder)
     {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(0);
-      pad->SetInput(inputImage);
-
-      m_CircDilate->SetInput(pad->GetOutput());
-
-      // writeIm<InputImageType>(m_CircCastB->GetOutput(), "dil.nii.gz");
-      // writeIm<InputImageType>(m_CircCastA->GetOutput(), "ero.nii.gz");
-      // m_CircCastA->UpdateOutputInformation();
+      // the first stage adds the border as it reads the input
+      m_CircDilate->SetBorderPad(Pad);
+      m_CircDilate->SetBorderValue(0);
+      m_CircDilate->SetInput(inputImage);
+
+      // writeIm<InputImageType>(m_CircDilate->GetOutput(), "dil.nii.gz");
+      // writeIm<InputImageType>(m_CircCast->GetOutput(), "ero.nii.gz");
+      // m_CircCast->UpdateOutputInformation();
       using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
       typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_CircCastA->GetOutput());
+      crop->SetInput(m_CircCast->GetOutput());
       crop->SetUpperBoundaryCropSize(Pad);
       crop->SetLowerBoundaryCropSize(Pad);
+      ParabolicShareThreadBudget(this, crop);
 
       crop->GraftOutput(this->GetOutput());
       crop->Update();
@@ -158,11 +307,12 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     }
     else
     {
+      m_CircDilate->SetBorderPad(TInputImage::SizeType::Filled(0));
       m_CircDilate->SetInput(inputImage);
-      m_CircCastA->GraftOutput(this->GetOutput());
-      m_CircCastA->Update();
+      m_CircCast->GraftOutput(this->GetOutput());
+      m_CircCast->Update();
 
-      this->GraftOutput(m_CircCastA->GetOutput());
+      this->GraftOutput(m_CircCast->GetOutput());
     }
   }
   else
@@ -172,36 +322,30 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     InputImageConstPointer inputImage;
     inputImage = this->GetInput();
 
-    progress->RegisterInternalFilter(m_RectErode, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastA, 0.1f);
-    progress->RegisterInternalFilter(m_RectDilate, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastB, 0.1f);
-
-    m_RectCastB->SetInput(m_RectDilate->GetOutput());
-    m_RectCastB->SetUpperThreshold(0);
-    m_RectCastB->SetOutsideValue(1);
-    m_RectCastB->SetInsideValue(0);
+    progress->RegisterInternalFilter(m_RectDilate, 0.45f);
+    progress->RegisterInternalFilter(m_RectErode, 0.45f);
+    progress->RegisterInternalFilter(m_RectCast, 0.1f);
+    ParabolicShareThreadBudget(this, m_RectDilate);
+    ParabolicShareThreadBudget(this, m_RectErode);
+    ParabolicShareThreadBudget(this, m_RectCast);
 
-    m_RectErode->SetInput(m_RectCastB->GetOutput());
-    m_RectCastA->SetInput(m_RectErode->GetOutput());
-    m_RectCastA->SetVal(1);
+    m_RectErode->SetInput(m_RectDilate->GetOutput());
+    m_RectCast->SetInput(m_RectErode->GetOutput());
+    m_RectCast->SetVal(1);
 
     if (m_SafeBorder)
     {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(0);
-      pad->SetInput(inputImage);
-
-      m_RectDilate->SetInput(pad->GetOutput());
+      // the first stage adds the border as it reads the input
+      m_RectDilate->SetBorderPad(Pad);
+      m_RectDilate->SetBorderValue(0);
+      m_RectDilate->SetInput(inputImage);
 
       using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
       typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_RectCastA->GetOutput());
+      crop->SetInput(m_RectCast->GetOutput());
       crop->SetUpperBoundaryCropSize(Pad);
       crop->SetLowerBoundaryCropSize(Pad);
+      ParabolicShareThreadBudget(this, crop);
 
       crop->GraftOutput(this->GetOutput());
       crop->Update();
@@ -209,10 +353,11 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     }
     else
     {
+      m_RectDilate->SetBorderPad(TInputImage::SizeType::Filled(0));
       m_RectDilate->SetInput(inputImage);
-      m_RectCastA->GraftOutput(this->GetOutput());
-      m_RectCastA->Update();
-      this->GraftOutput(m_RectCastA->GetOutput());
+      m_RectCast->GraftOutput(this->GetOutput());
+      m_RectCast->Update();
+      this->GraftOutput(m_RectCast->GetOutput());
     }
   }
 }
@@ -222,6 +367,7 @@ void
 BinaryCloseParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "CompactIntermediates: " << m_CompactIntermediates << std::endl;
   if (this->m_CircErode->GetUseImageSpacing())
   {
     os << "Radius in world units: " << this->GetRadius() << std::endl;
@@ -118,6 +118,7 @@ public:
   {
     m_RectPara->SetUseImageSpacing(g);
     m_CircPara->SetUseImageSpacing(g);
+    m_CompactPara->SetUseImageSpacing(g);
   }
 
   /**
@@ -127,6 +128,30 @@ public:
   itkSetMacro(Circular, bool);
   itkGetConstReferenceMacro(Circular, bool);
   itkBooleanMacro(Circular);
+
+  /**
+   * Set/Get whether the circular dilation keeps its intermediate image
+   * as 16-bit fixed point instead of float - default is false. The
+   * intermediate then takes half the memory and bandwidth, and the
+   * mask is scaled as the dilation reads it. Truncation between passes can drop
+   * a pixel whose distance from the mask is within a relative
+   * ImageDimension / 32768 of the radius; with radii in pixels the
+   * result matches the float one up to a radius of about 90 pixels in
+   * 2D and 73 in 3D. Rectangular dilations are unaffected.
+   */
+  itkSetMacro(CompactIntermediates, bool);
+  itkGetConstReferenceMacro(CompactIntermediates, bool);
+  itkBooleanMacro(CompactIntermediates);
+
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing,
+   * including the image the parabolic dilation writes before it is
+   * thresholded. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
   /** Image related type alias. */
 
   /* add in the traits here */
@@ -145,16 +170,26 @@ protected:
   using RectParabolicType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalRealImageType>;
   using CCastType = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
   using RCastType = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CompactParabolicType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalIntImageType>;
+  using CompactCastType = typename itk::BinaryThresholdImageFilter<InternalIntImageType, OutputImageType>;
 
 private:
+  // the scale of the parabolic filters for m_Radius
+  RadiusType
+  GetParabolicScale() const;
+
   RadiusType m_Radius;
   bool       m_Circular;
+  bool       m_CompactIntermediates;
 
   typename CircParabolicType::Pointer m_CircPara;
   typename CCastType::Pointer         m_CircCast;
 
   typename RectParabolicType::Pointer m_RectPara;
   typename RCastType::Pointer         m_RectCast;
+
+  typename CompactParabolicType::Pointer m_CompactPara;
+  typename CompactCastType::Pointer      m_CompactCast;
 };
 } // end namespace itk
 
@@ -20,6 +20,7 @@
 
 #include "itkParabolicErodeImageFilter.h"
 #include "itkGreaterEqualValImageFilter.h"
+#include "itkBinaryThresholdImageFilter.h"
 
 namespace itk
 {
@@ -116,6 +117,7 @@ public:
   {
     m_RectPara->SetUseImageSpacing(g);
     m_CircPara->SetUseImageSpacing(g);
+    m_CompactPara->SetUseImageSpacing(g);
   }
 
   /**
@@ -125,6 +127,31 @@ public:
   itkSetMacro(Circular, bool);
   itkGetConstReferenceMacro(Circular, bool);
   itkBooleanMacro(Circular);
+
+  /**
+   * Set/Get whether the circular erosion keeps its intermediate image
+   * as 16-bit fixed point instead of float - default is false. The
+   * mask is scaled as the erosion reads it, and the intermediate
+   * takes half the memory and bandwidth. Because of the truncation between
+   * passes a pixel just inside the radius of the background may be
+   * kept. It takes a radius of about 90 pixels in 2D, or 73 in 3D, for
+   * that to happen when radii are in pixels. Rectangular erosions
+   * already use integer intermediates.
+   */
+  itkSetMacro(CompactIntermediates, bool);
+  itkGetConstReferenceMacro(CompactIntermediates, bool);
+  itkBooleanMacro(CompactIntermediates);
+
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing,
+   * including the real (circular), integer (rectangular) or fixed
+   * point (CompactIntermediates) image the parabolic erosion writes
+   * before it is thresholded. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
   /** Image related type alias. */
 
   /* add in the traits here */
@@ -146,16 +173,26 @@ protected:
   using RectParabolicType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalIntImageType>;
   using CCastType = typename itk::GreaterEqualValImageFilter<InternalRealImageType, OutputImageType>;
   using RCastType = typename itk::GreaterEqualValImageFilter<InternalIntImageType, OutputImageType>;
+  using CompactParabolicType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalIntImageType>;
+  using CompactCastType = typename itk::GreaterEqualValImageFilter<InternalIntImageType, OutputImageType>;
 
 private:
+  // the scale of the parabolic filters for m_Radius
+  RadiusType
+  GetParabolicScale() const;
+
   RadiusType m_Radius;
   bool       m_Circular;
+  bool       m_CompactIntermediates;
 
   typename CircParabolicType::Pointer m_CircPara;
   typename CCastType::Pointer         m_CircCast;
 
   typename RectParabolicType::Pointer m_RectPara;
   typename RCastType::Pointer         m_RectCast;
+
+  typename CompactParabolicType::Pointer m_CompactPara;
+  typename CompactCastType::Pointer      m_CompactCast;
 };
 } // end namespace itk
 
@@ -19,6 +19,7 @@
 #define itkBinaryErodeParaImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 #include "itkParabolicErodeImageFilter.h"
 #include "itkProgressAccumulator.h"
 
@@ -34,7 +35,20 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::BinaryErodeParaImageFilte
 
   this->m_RectPara = RectParabolicType::New();
   this->m_RectCast = RCastType::New();
+
+  this->m_CompactPara = CompactParabolicType::New();
+  // store the 0/1 mask as 0/ParabolicFixedPointOne as it is read
+  using CompactRealType = typename CompactParabolicType::RealType;
+  this->m_CompactPara->SetPrologue(ParabolicPointwise<CompactRealType>(
+    [](const CompactRealType v) { return v >= 1 ? CompactRealType(ParabolicFixedPointOne) : CompactRealType(0); }));
+  this->m_CompactPara->SetValueRange(ParabolicFixedPointOne);
+  this->m_CompactCast = CompactCastType::New();
+  // the thresholds only need the parabolic result until they have run
+  this->m_CircPara->ReleaseDataFlagOn();
+  this->m_RectPara->ReleaseDataFlagOn();
+  this->m_CompactPara->ReleaseDataFlagOn();
   this->m_Circular = true;
+  this->m_CompactIntermediates = false;
   // Need to call this after filters are created
   this->SetUseImageSpacing(false);
 }
@@ -50,39 +64,97 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::SetRadius(ScalarRealType
 }
 
 template <typename TInputImage, typename TOutputImage>
-void
-BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GenerateData()
+auto
+BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GetParabolicScale() const -> RadiusType
 {
-  // Allocate the output
-  this->AllocateOutputs();
-  // set up the scaling before we pass control over to superclass
-  if (this->m_RectPara->GetUseImageSpacing())
+  RadiusType R;
+  for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
   {
-    // radius is in mm
-    RadiusType R;
-    for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+    if (this->m_RectPara->GetUseImageSpacing())
     {
+      // radius is in mm
       R[P] = 0.5 * m_Radius[P] * m_Radius[P];
-      // this->SetScale(0.5*m_Radius[P] * m_Radius[P]);
     }
-    m_RectPara->SetScale(R);
-    m_CircPara->SetScale(R);
+    else
+    {
+      // radius is in pixels - this gives us a little bit of a margin
+      R[P] = (0.5 * m_Radius[P] * m_Radius[P] + 1);
+    }
+  }
+  return R;
+}
+
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+BinaryErodeParaImageFilter<TInputImage, TOutputImage>::EstimateCost(const SizeType &    size,
+                                                                    const SpacingType & spacing) const
+{
+  // stand ins for the internal filters, set up as GenerateData would
+  auto estimate = [&](auto para) {
+    para->SetScale(this->GetParabolicScale());
+    para->SetUseImageSpacing(m_CircPara->GetUseImageSpacing());
+    para->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    return para->EstimateCost(size, spacing);
+  };
+  ParabolicCostEstimate cost;
+  if (m_Circular && m_CompactIntermediates)
+  {
+    // the mask is scaled as the erosion reads it
+    cost = estimate(CompactParabolicType::New());
   }
   else
   {
-    // radius is in pixels
-    RadiusType R;
-    // this gives us a little bit of a margin
+    cost = m_Circular ? estimate(CircParabolicType::New()) : estimate(RectParabolicType::New());
+  }
+
+  // the threshold writes the output
+  cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(size);
+  cost.Operations += static_cast<double>(typename TInputImage::RegionType(size).GetNumberOfPixels());
+  return cost;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  // Allocate the output
+  this->AllocateOutputs();
+  // set up the scaling before we pass control over to superclass
+  const RadiusType R = this->GetParabolicScale();
+  m_RectPara->SetScale(R);
+  m_CircPara->SetScale(R);
+
+  if (m_Circular && m_CompactIntermediates)
+  {
+    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+    progress->SetMiniPipelineFilter(this);
+    InputImageConstPointer inputImage;
+    inputImage = this->GetInput();
+
+    progress->RegisterInternalFilter(m_CompactPara, 0.8f);
+    progress->RegisterInternalFilter(m_CompactCast, 0.2f);
+    ParabolicShareThreadBudget(this, m_CompactPara);
+    ParabolicShareThreadBudget(this, m_CompactCast);
+
+    // 1 in the mask is stored as ParabolicFixedPointOne by the
+    // erosion's prologue, and the scale is reduced to match
+    RadiusType compactR;
     for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
     {
-      R[P] = (0.5 * m_Radius[P] * m_Radius[P] + 1);
+      compactR[P] = R[P] / ParabolicFixedPointOne;
     }
-    // std::cout << "no image spacing " << m_Radius << R << std::endl;
-    m_RectPara->SetScale(R);
-    m_CircPara->SetScale(R);
-  }
+    m_CompactPara->SetScale(compactR);
+    m_CompactPara->SetInput(inputImage);
 
-  if (m_Circular)
+    // each pass can lose up to one to truncation, so the threshold
+    // that is 1.0 for float intermediates comes down by a unit per pass
+    m_CompactCast->SetInput(m_CompactPara->GetOutput());
+    m_CompactCast->SetVal(ParabolicFixedPointOne - InputImageType::ImageDimension);
+    m_CompactCast->GraftOutput(this->GetOutput());
+    m_CompactCast->Update();
+    this->GraftOutput(m_CompactCast->GetOutput());
+  }
+  else if (m_Circular)
   {
     ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
     progress->SetMiniPipelineFilter(this);
@@ -91,6 +163,8 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GenerateData()
 
     progress->RegisterInternalFilter(m_CircPara, 0.8f);
     progress->RegisterInternalFilter(m_CircCast, 0.2f);
+    ParabolicShareThreadBudget(this, m_CircPara);
+    ParabolicShareThreadBudget(this, m_CircCast);
 
     m_CircPara->SetInput(inputImage);
     m_CircCast->SetInput(m_CircPara->GetOutput());
@@ -117,6 +191,8 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GenerateData()
 
     progress->RegisterInternalFilter(m_RectPara, 0.8f);
     progress->RegisterInternalFilter(m_RectCast, 0.2f);
+    ParabolicShareThreadBudget(this, m_RectPara);
+    ParabolicShareThreadBudget(this, m_RectCast);
 
     m_RectPara->SetInput(inputImage);
     m_RectCast->SetInput(m_RectPara->GetOutput());
@@ -132,6 +208,7 @@ void
 BinaryErodeParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "CompactIntermediates: " << m_CompactIntermediates << std::endl;
   if (this->m_CircPara->GetUseImageSpacing())
   {
     os << "Radius in world units: " << this->GetRadius() << std::endl;
@@ -151,6 +228,8 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::Modified() const
   m_CircCast->Modified();
   m_RectPara->Modified();
   m_RectCast->Modified();
+  m_CompactPara->Modified();
+  m_CompactCast->Modified();
 }
 } // namespace itk
 #endif
@@ -20,7 +20,6 @@
 
 #include "itkParabolicErodeImageFilter.h"
 #include "itkParabolicDilateImageFilter.h"
-#include "itkGreaterEqualValImageFilter.h"
 #include "itkBinaryThresholdImageFilter.h"
 
 namespace itk
@@ -119,6 +118,8 @@ public:
     m_RectDilate->SetUseImageSpacing(g);
     m_CircErode->SetUseImageSpacing(g);
     m_CircDilate->SetUseImageSpacing(g);
+    m_CompactErode->SetUseImageSpacing(g);
+    m_CompactDilate->SetUseImageSpacing(g);
   }
 
   /**
@@ -135,6 +136,30 @@ public:
   itkGetConstReferenceMacro(SafeBorder, bool);
   itkBooleanMacro(SafeBorder);
 
+  /**
+   * Set/Get whether a circular opening keeps its intermediate images
+   * as 16-bit fixed point instead of float - default is false. The
+   * erosion scales the mask as it reads it, and the dilation
+   * thresholds the erosion as it reads it, in place, so the float
+   * intermediate is replaced by a 16-bit image. Truncation
+   * can move the edge of either stage by a pixel whose distance is
+   * within a relative ImageDimension / 32768 of the radius, which
+   * with radii in pixels takes a radius of about 90 (2D) or 73 (3D).
+   */
+  itkSetMacro(CompactIntermediates, bool);
+  itkGetConstReferenceMacro(CompactIntermediates, bool);
+  itkBooleanMacro(CompactIntermediates);
+
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing.
+   * Every internal image of the mini-pipeline is counted, at the
+   * padded size when SafeBorder is on. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
+
   /** Image related type alias. */
 
   /* add in the traits here */
@@ -151,31 +176,39 @@ protected:
   using InternalIntImageType = typename itk::Image<InternalIntType, InputImageType::ImageDimension>;
   using CircErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalRealImageType>;
   using RectErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalIntImageType>;
-  using CircDilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, InternalRealImageType>;
-  using RectDilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, InternalRealImageType>;
+  // the dilations threshold the erosion as they read it
+  using CircDilateType = typename itk::ParabolicDilateImageFilter<InternalRealImageType, InternalRealImageType>;
+  using RectDilateType = typename itk::ParabolicDilateImageFilter<InternalIntImageType, InternalRealImageType>;
 
-  using CCastTypeA = typename itk::GreaterEqualValImageFilter<InternalRealImageType, OutputImageType>;
-  using CCastTypeB = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CCastType = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using RCastType = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
 
-  using RCastTypeA = typename itk::GreaterEqualValImageFilter<InternalIntImageType, OutputImageType>;
-  using RCastTypeB = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CompactErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalIntImageType>;
+  using CompactDilateType = typename itk::ParabolicDilateImageFilter<InternalIntImageType, InternalIntImageType>;
+  using CompactCastType = typename itk::BinaryThresholdImageFilter<InternalIntImageType, OutputImageType>;
 
 private:
+  // the scale of the parabolic filters, and the width of the safe
+  // border, for m_Radius on an image with the given spacing
+  void
+  GetParabolicScale(const SpacingType & spacing, RadiusType & scale, SizeType & pad) const;
+
   RadiusType m_Radius;
   bool       m_Circular;
   bool       m_SafeBorder;
+  bool       m_CompactIntermediates;
 
   typename CircErodeType::Pointer  m_CircErode;
   typename CircDilateType::Pointer m_CircDilate;
-
-  typename CCastTypeA::Pointer m_CircCastA;
-  typename CCastTypeB::Pointer m_CircCastB;
+  typename CCastType::Pointer      m_CircCast;
 
   typename RectErodeType::Pointer  m_RectErode;
   typename RectDilateType::Pointer m_RectDilate;
+  typename RCastType::Pointer      m_RectCast;
 
-  typename RCastTypeA::Pointer m_RectCastA;
-  typename RCastTypeB::Pointer m_RectCastB;
+  typename CompactErodeType::Pointer  m_CompactErode;
+  typename CompactDilateType::Pointer m_CompactDilate;
+  typename CompactCastType::Pointer   m_CompactCast;
 };
 } // end namespace itk
 
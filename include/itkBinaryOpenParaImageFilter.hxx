@@ -19,10 +19,10 @@
 #define itkBinaryOpenParaImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 #include "itkParabolicErodeImageFilter.h"
 #include "itkProgressAccumulator.h"
 #include "itkCropImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkMath.h"
 
 namespace itk
@@ -34,13 +34,53 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::BinaryOpenParaImageFilter(
   this->SetNumberOfRequiredInputs(1);
   this->m_CircErode = CircErodeType::New();
   this->m_CircDilate = CircDilateType::New();
-  this->m_CircCastA = CCastTypeA::New();
-  this->m_CircCastB = CCastTypeB::New();
+  this->m_CircCast = CCastType::New();
 
   this->m_RectErode = RectErodeType::New();
   this->m_RectDilate = RectDilateType::New();
-  this->m_RectCastA = RCastTypeA::New();
-  this->m_RectCastB = RCastTypeB::New();
+  this->m_RectCast = RCastType::New();
+
+  this->m_CompactErode = CompactErodeType::New();
+  this->m_CompactDilate = CompactDilateType::New();
+  this->m_CompactCast = CompactCastType::New();
+
+  // The dilations threshold the erosion as they read it, rather than
+  // in a pass of their own, and work in place on it when they can.
+  using CircRealType = typename CircDilateType::RealType;
+  this->m_CircDilate->SetPrologue(ParabolicPointwise<CircRealType>(
+    [](const CircRealType v) { return v >= 1 ? CircRealType(1) : CircRealType(0); }));
+  this->m_CircDilate->SetValueRange(1);
+  this->m_CircDilate->InPlaceOn();
+  using RectRealType = typename RectDilateType::RealType;
+  this->m_RectDilate->SetPrologue(ParabolicPointwise<RectRealType>(
+    [](const RectRealType v) { return v >= 1 ? RectRealType(1) : RectRealType(0); }));
+  this->m_RectDilate->SetValueRange(1);
+
+  // 16-bit fixed point throughout: the erosion stores the 0/1 mask as
+  // 0/ParabolicFixedPointOne. Truncation lowers each value by less
+  // than one per pass, so eroded values at least
+  // ParabolicFixedPointOne - ImageDimension are inside.
+  using CompactRealType = typename CompactErodeType::RealType;
+  this->m_CompactErode->SetPrologue(ParabolicPointwise<CompactRealType>(
+    [](const CompactRealType v) { return v >= 1 ? CompactRealType(ParabolicFixedPointOne) : CompactRealType(0); }));
+  this->m_CompactErode->SetValueRange(ParabolicFixedPointOne);
+  this->m_CompactDilate->SetPrologue(ParabolicPointwise<CompactRealType>([](const CompactRealType v) {
+    return v >= ParabolicFixedPointOne - InputImageType::ImageDimension ? CompactRealType(ParabolicFixedPointOne)
+                                                                         : CompactRealType(0);
+  }));
+  this->m_CompactDilate->SetValueRange(ParabolicFixedPointOne);
+  this->m_CompactDilate->InPlaceOn();
+
+  // Each erode and dilate stage has a single reader, so its output can
+  // go as soon as that has run. The casts are left alone: their output
+  // is grafted onto ours when there is no border to crop.
+  this->m_CircErode->ReleaseDataFlagOn();
+  this->m_CircDilate->ReleaseDataFlagOn();
+  this->m_RectErode->ReleaseDataFlagOn();
+  this->m_RectDilate->ReleaseDataFlagOn();
+  this->m_CompactErode->ReleaseDataFlagOn();
+  this->m_CompactDilate->ReleaseDataFlagOn();
+  this->m_CompactIntermediates = false;
   this->m_Circular = true;
   // Need to call this after filters are created
   this->SetUseImageSpacing(false);
@@ -57,6 +97,94 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::SetRadius(ScalarRealType r
   this->SetRadius(s);
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GetParabolicScale(const SpacingType & spacing,
+                                                                        RadiusType &        scale,
+                                                                        SizeType &          pad) const
+{
+  for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+  {
+    if (this->m_RectErode->GetUseImageSpacing())
+    {
+      // radius is in mm - need to do an adjustment to make sure that we
+      // end up with an odd number of voxels for the radius
+      typename TInputImage::SpacingValueType tsp = spacing[P];
+      scale[P] = 0.5 * (m_Radius[P] * m_Radius[P]) + tsp * tsp;
+      pad[P] = (typename TInputImage::SizeType::SizeValueType)(itk::Math::rnd_halfinttoeven(m_Radius[P] / tsp) + 2);
+    }
+    else
+    {
+      // radius is in pixels - this gives us a little bit of a margin
+      scale[P] = (0.5 * m_Radius[P] * m_Radius[P] + 1);
+      pad[P] = (typename TInputImage::SizeType::SizeValueType)m_Radius[P] + 1;
+    }
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+BinaryOpenParaImageFilter<TInputImage, TOutputImage>::EstimateCost(const SizeType &    size,
+                                                                   const SpacingType & spacing) const
+{
+  RadiusType scale;
+  SizeType   pad;
+  this->GetParabolicScale(spacing, scale, pad);
+  if (!m_SafeBorder)
+  {
+    pad.Fill(0);
+  }
+  // the first stage adds the border, so every image up to the crop
+  // is padded
+  SizeType padded;
+  for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+  {
+    padded[P] = size[P] + 2 * pad[P];
+  }
+
+  // stand ins for the internal filters, set up as GenerateData would
+  auto stage = [&](auto para, const SizeType & inputSize, const SizeType & border) {
+    para->SetScale(scale);
+    para->SetUseImageSpacing(m_CircErode->GetUseImageSpacing());
+    para->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    para->SetBorderPad(border);
+    return para->EstimateCost(inputSize, spacing);
+  };
+  ParabolicCostEstimate cost;
+  if (m_Circular && m_CompactIntermediates)
+  {
+    // the erosion, then the dilation in place on it
+    cost += stage(CompactErodeType::New(), size, pad);
+    typename CompactDilateType::Pointer second = CompactDilateType::New();
+    second->InPlaceOn();
+    cost += stage(second, padded, SizeType::Filled(0));
+  }
+  else if (m_Circular)
+  {
+    cost += stage(CircErodeType::New(), size, pad);
+    typename CircDilateType::Pointer second = CircDilateType::New();
+    second->InPlaceOn();
+    cost += stage(second, padded, SizeType::Filled(0));
+  }
+  else
+  {
+    cost += stage(RectErodeType::New(), size, pad);
+    cost += stage(RectDilateType::New(), padded, SizeType::Filled(0));
+  }
+
+  // the threshold between the stages is part of the second, so there
+  // is one threshold to the output type, then the crop when there is
+  // a border
+  cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(padded);
+  cost.Operations += static_cast<double>(typename TInputImage::RegionType(padded).GetNumberOfPixels());
+  if (m_SafeBorder)
+  {
+    cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(size);
+    cost.Operations += static_cast<double>(typename TInputImage::RegionType(size).GetNumberOfPixels());
+  }
+  return cost;
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateData()
@@ -75,84 +203,104 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateData()
   // margin = 1.0/(pow(mxRad, TInputImage::ImageDimension) * 10);
   // margin = std::min(margin, 0.00001);
   // set up the scaling before we pass control over to superclass
-  if (this->m_RectErode->GetUseImageSpacing())
+  RadiusType R;
+  this->GetParabolicScale(this->GetInput()->GetSpacing(), R, Pad);
+  m_RectErode->SetScale(R);
+  m_CircErode->SetScale(R);
+  m_RectDilate->SetScale(R);
+  m_CircDilate->SetScale(R);
+
+  if (m_Circular && m_CompactIntermediates)
   {
-    // radius is in mm - need to do an adjustment to make sure that we
-    // end up with an odd number of voxels for the radius
-    RadiusType R;
+    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+    progress->SetMiniPipelineFilter(this);
+    InputImageConstPointer inputImage;
+    inputImage = this->GetInput();
+
+    progress->RegisterInternalFilter(m_CompactErode, 0.45f);
+    progress->RegisterInternalFilter(m_CompactDilate, 0.45f);
+    progress->RegisterInternalFilter(m_CompactCast, 0.1f);
+    ParabolicShareThreadBudget(this, m_CompactErode);
+    ParabolicShareThreadBudget(this, m_CompactDilate);
+    ParabolicShareThreadBudget(this, m_CompactCast);
+
+    // 16-bit fixed point throughout: 1 is ParabolicFixedPointOne, and
+    // the scale shrinks by the same factor
+    RadiusType compactR;
     for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
     {
-      typename TInputImage::SpacingValueType tsp = this->GetInput()->GetSpacing()[P];
-
-      // int thisvox=(int)round(m_Radius[P]/this->GetInput()->GetSpacing()[P]);
-      // if (thisvox % 2 == 0) ++thisvox;
-      // std::cout << thisvox << std::endl;
-      // float thisRad = thisvox * this->GetInput()->GetSpacing()[P];
-      // R[P] = 0.5 * thisRad * thisRad +
-      // this->GetInput()->GetSpacing()[P];
-      R[P] = 0.5 * (m_Radius[P] * m_Radius[P]) + tsp * tsp;
-      Pad[P] = (typename TInputImage::SizeType::SizeValueType)(itk::Math::rnd_halfinttoeven(m_Radius[P] / tsp) + 2);
+      compactR[P] = R[P] / ParabolicFixedPointOne;
     }
-    m_RectErode->SetScale(R);
-    m_CircErode->SetScale(R);
-    m_RectDilate->SetScale(R);
-    m_CircDilate->SetScale(R);
-  }
-  else
-  {
-    // radius is in pixels
-    RadiusType R;
-    // this gives us a little bit of a margin
-    for (unsigned P = 0; P < InputImageType::ImageDimension; P++)
+    m_CompactErode->SetScale(compactR);
+    m_CompactDilate->SetScale(compactR);
+
+    // the first stage adds the border as it reads and scales the mask,
+    // so everything after it can work in place
+    m_CompactErode->SetInput(inputImage);
+    m_CompactErode->SetBorderPad(m_SafeBorder ? Pad : TInputImage::SizeType::Filled(0));
+    m_CompactErode->SetBorderValue(1);
+
+    m_CompactDilate->SetInput(m_CompactErode->GetOutput());
+
+    // dilated values above 0 are inside
+    m_CompactCast->SetInput(m_CompactDilate->GetOutput());
+    m_CompactCast->SetLowerThreshold(1);
+    m_CompactCast->SetInsideValue(1);
+    m_CompactCast->SetOutsideValue(0);
+
+    if (m_SafeBorder)
     {
-      R[P] = (0.5 * m_Radius[P] * m_Radius[P] + 1);
-      Pad[P] = (typename TInputImage::SizeType::SizeValueType)m_Radius[P] + 1;
+      using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
+      typename CropType::Pointer crop = CropType::New();
+      crop->SetInput(m_CompactCast->GetOutput());
+      crop->SetUpperBoundaryCropSize(Pad);
+      crop->SetLowerBoundaryCropSize(Pad);
+      ParabolicShareThreadBudget(this, crop);
+
+      crop->GraftOutput(this->GetOutput());
+      crop->Update();
+      this->GraftOutput(crop->GetOutput());
+    }
+    else
+    {
+      m_CompactCast->GraftOutput(this->GetOutput());
+      m_CompactCast->Update();
+      this->GraftOutput(m_CompactCast->GetOutput());
     }
-    // std::cout << "no image spacing " << m_Radius << R << std::endl;
-    std::cout << Pad << R << std::endl;
-    m_RectErode->SetScale(R);
-    m_CircErode->SetScale(R);
-    m_RectDilate->SetScale(R);
-    m_CircDilate->SetScale(R);
   }
-
-  if (m_Circular)
+  else if (m_Circular)
   {
     ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
     progress->SetMiniPipelineFilter(this);
     InputImageConstPointer inputImage;
     inputImage = this->GetInput();
 
-    progress->RegisterInternalFilter(m_CircErode, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastA, 0.1f);
-    progress->RegisterInternalFilter(m_CircDilate, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastB, 0.1f);
+    progress->RegisterInternalFilter(m_CircErode, 0.45f);
+    progress->RegisterInternalFilter(m_CircDilate, 0.45f);
+    progress->RegisterInternalFilter(m_CircCast, 0.1f);
+    ParabolicShareThreadBudget(this, m_CircErode);
+    ParabolicShareThreadBudget(this, m_CircDilate);
+    ParabolicShareThreadBudget(this, m_CircCast);
 
-    m_CircCastA->SetInput(m_CircErode->GetOutput());
-    //    m_CircCastA->SetVal(1.0 - margin);
-    m_CircCastA->SetVal(1.0);
+    m_CircDilate->SetInput(m_CircErode->GetOutput());
 
-    m_CircDilate->SetInput(m_CircCastA->GetOutput());
-
-    m_CircCastB->SetInput(m_CircDilate->GetOutput());
-    m_CircCastB->SetUpperThreshold(0.0);
-    m_CircCastB->SetOutsideValue(1);
-    m_CircCastB->SetInsideValue(0);
+    m_CircCast->SetInput(m_CircDilate->GetOutput());
+    m_CircCast->SetUpperThreshold(0.0);
+    m_CircCast->SetOutsideValue(1);
+    m_CircCast->SetInsideValue(0);
 
     if (m_SafeBorder)
     {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(1);
-      pad->SetInput(inputImage);
-      m_CircErode->SetInput(pad->GetOutput());
+      // the first stage adds the border as it reads the input
+      m_CircErode->SetBorderPad(Pad);
+      m_CircErode->SetBorderValue(1);
+      m_CircErode->SetInput(inputImage);
       using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
       typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_CircCastB->GetOutput());
+      crop->SetInput(m_CircCast->GetOutput());
       crop->SetUpperBoundaryCropSize(Pad);
       crop->SetLowerBoundaryCropSize(Pad);
+      ParabolicShareThreadBudget(this, crop);
 
       crop->GraftOutput(this->GetOutput());
       crop->Update();
@@ -160,11 +308,12 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     }
     else
     {
+      m_CircErode->SetBorderPad(TInputImage::SizeType::Filled(0));
       m_CircErode->SetInput(inputImage);
 
-      m_CircCastB->GraftOutput(this->GetOutput());
-      m_CircCastB->Update();
-      this->GraftOutput(m_CircCastB->GetOutput());
+      m_CircCast->GraftOutput(this->GetOutput());
+      m_CircCast->Update();
+      this->GraftOutput(m_CircCast->GetOutput());
     }
   }
   else
@@ -174,36 +323,33 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     InputImageConstPointer inputImage;
     inputImage = this->GetInput();
 
-    progress->RegisterInternalFilter(m_RectErode, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastA, 0.1f);
-    progress->RegisterInternalFilter(m_RectDilate, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastB, 0.1f);
+    progress->RegisterInternalFilter(m_RectErode, 0.45f);
+    progress->RegisterInternalFilter(m_RectDilate, 0.45f);
+    progress->RegisterInternalFilter(m_RectCast, 0.1f);
+    ParabolicShareThreadBudget(this, m_RectErode);
+    ParabolicShareThreadBudget(this, m_RectDilate);
+    ParabolicShareThreadBudget(this, m_RectCast);
 
-    m_RectCastA->SetInput(m_RectErode->GetOutput());
-    m_RectCastA->SetVal(1);
+    m_RectDilate->SetInput(m_RectErode->GetOutput());
 
-    m_RectDilate->SetInput(m_RectCastA->GetOutput());
-
-    m_RectCastB->SetInput(m_RectDilate->GetOutput());
-    m_RectCastB->SetUpperThreshold(0);
-    m_RectCastB->SetOutsideValue(1);
-    m_RectCastB->SetInsideValue(0);
+    m_RectCast->SetInput(m_RectDilate->GetOutput());
+    m_RectCast->SetUpperThreshold(0);
+    m_RectCast->SetOutsideValue(1);
+    m_RectCast->SetInsideValue(0);
 
     if (m_SafeBorder)
     {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(1);
-      pad->SetInput(inputImage);
-      m_RectErode->SetInput(pad->GetOutput());
+      // the first stage adds the border as it reads the input
+      m_RectErode->SetBorderPad(Pad);
+      m_RectErode->SetBorderValue(1);
+      m_RectErode->SetInput(inputImage);
 
       using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
       typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_RectCastB->GetOutput());
+      crop->SetInput(m_RectCast->GetOutput());
       crop->SetUpperBoundaryCropSize(Pad);
       crop->SetLowerBoundaryCropSize(Pad);
+      ParabolicShareThreadBudget(this, crop);
 
       crop->GraftOutput(this->GetOutput());
       crop->Update();
@@ -211,11 +357,12 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     }
     else
     {
+      m_RectErode->SetBorderPad(TInputImage::SizeType::Filled(0));
       m_RectErode->SetInput(inputImage);
-      m_RectCastB->GraftOutput(this->GetOutput());
-      m_RectCastB->Update();
+      m_RectCast->GraftOutput(this->GetOutput());
+      m_RectCast->Update();
 
-      this->GraftOutput(m_RectCastB->GetOutput());
+      this->GraftOutput(m_RectCast->GetOutput());
     }
   }
 }
@@ -225,6 +372,7 @@ void
 BinaryOpenParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "CompactIntermediates: " << m_CompactIntermediates << std::endl;
   if (this->m_Circular)
   {
     os << "Circular opening, ";
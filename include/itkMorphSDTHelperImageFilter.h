@@ -45,6 +45,17 @@ public:
   {
     m_Val = i;
   }
+  // Choose the branch from the original mask rather than the sign of
+  // the third input, so that it doesn't have to be kept: pixels equal
+  // to value take the erosion branch if valueIsPositive, and the
+  // dilation branch otherwise.
+  void
+  SetMaskValue(const TInput3 & value, bool valueIsPositive)
+  {
+    m_MaskValue = value;
+    m_MaskValueIsPositive = valueIsPositive;
+    m_UseMaskValue = true;
+  }
   bool
   operator!=(const MorphSDTHelper &) const
   {
@@ -61,7 +72,8 @@ public:
   operator()(const TInput1 & A, const TInput2 & B, const TInput3 & C)
   {
     // A should be the output of the erosion, B the dilation, C the mask
-    if (C > 0)
+    const bool positive = m_UseMaskValue ? ((C == m_MaskValue) == m_MaskValueIsPositive) : (C > 0);
+    if (positive)
     {
       // inside the mask
       return static_cast<TOutput>(std::sqrt((double)A + m_Val));
@@ -74,7 +86,10 @@ public:
   }
 
 private:
-  double m_Val;
+  double  m_Val;
+  TInput3 m_MaskValue{};
+  bool    m_MaskValueIsPositive{ true };
+  bool    m_UseMaskValue{ false };
 };
 } // namespace Function
 
@@ -122,6 +137,15 @@ public:
     this->Modified();
   }
 
+  /** Take the sign of the result from the third input compared with
+   * a mask value, instead of from the sign of the third input. */
+  void
+  SetMaskValue(const typename TInputImage3::PixelType & value, bool valueIsPositive)
+  {
+    this->GetFunctor().SetMaskValue(value, valueIsPositive);
+    this->Modified();
+  }
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(Input1ConvertibleToOutputCheck,
@@ -21,9 +21,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkProgressReporter.h"
 
-#include "itkBinaryThresholdImageFilter.h"
 #include "itkParabolicErodeImageFilter.h"
-#include "itkSqrtImageFilter.h"
 
 namespace itk
 {
@@ -43,6 +41,17 @@ namespace itk
  * square of the largest value of the distance - just use float to be
  * safe.
  *
+ * The threshold of the mask and the square root are the prologue and
+ * epilogue of the erosion, so the transform makes one pass over memory
+ * per direction and allocates only the output. The erosion uses the
+ * multithreader and number of work units set on this filter.
+ *
+ * The threshold and square root act on single pixels, so the
+ * transform can be distributed by slab in the same way as
+ * ParabolicErodeDilateImageFilter: threshold each slab, erode it along
+ * the directions within it, exchange slabs, erode along the remaining
+ * direction and take the square root.
+ *
  * Core methods described in the InsightJournal article:
  * "Morphology with parabolic structuring elements"
  *
@@ -115,10 +124,35 @@ public:
     return m_Erode->GetUseImageSpacing();
   }
 
+  /** Set/Get a file to checkpoint the passes of the erosion to, so
+   * that a job killed part way through only redoes the pass it was
+   * in. See ParabolicErodeDilateImageFilter::SetCheckpointFileName. */
+  void
+  SetCheckpointFileName(const std::string & fileName)
+  {
+    m_Erode->SetCheckpointFileName(fileName);
+    this->Modified();
+  }
+
+  const char *
+  GetCheckpointFileName() const
+  {
+    return m_Erode->GetCheckpointFileName();
+  }
+
   itkSetMacro(SqrDist, bool);
   itkGetConstReferenceMacro(SqrDist, bool);
   itkBooleanMacro(SqrDist);
 
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing,
+   * which are those of the erosion that writes the output. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
@@ -139,17 +173,14 @@ protected:
   void
   GenerateData() override;
 
-  // do everything in the output image type, which should have high precision
-  using ThreshType = typename itk::BinaryThresholdImageFilter<InputImageType, OutputImageType>;
-  using ErodeType = typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType>;
-  using SqrtType = typename itk::SqrtImageFilter<OutputImageType, OutputImageType>;
+  // the passes store their results in the output image type, which
+  // should have high precision
+  using ErodeType = typename itk::ParabolicErodeImageFilter<InputImageType, OutputImageType>;
 
 private:
-  InputPixelType               m_OutsideValue;
-  typename ErodeType::Pointer  m_Erode;
-  typename ThreshType::Pointer m_Thresh;
-  typename SqrtType::Pointer   m_Sqrt;
-  bool                         m_SqrDist;
+  InputPixelType              m_OutsideValue;
+  typename ErodeType::Pointer m_Erode;
+  bool                        m_SqrDist;
 };
 } // namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
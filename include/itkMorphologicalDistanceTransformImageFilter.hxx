@@ -19,6 +19,7 @@
 #define itkMorphologicalDistanceTransformImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
@@ -29,8 +30,6 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::Morphologi
   this->SetNumberOfRequiredInputs(1);
 
   m_Erode = ErodeType::New();
-  m_Thresh = ThreshType::New();
-  m_Sqrt = SqrtType::New();
   m_OutsideValue = 0;
   m_Erode->SetScale(0.5);
   this->SetUseImageSpacing(true);
@@ -43,8 +42,6 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::Modified()
 {
   Superclass::Modified();
   m_Erode->Modified();
-  m_Thresh->Modified();
-  m_Sqrt->Modified();
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -54,11 +51,8 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::GenerateDa
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
 
   progress->SetMiniPipelineFilter(this);
-  // these values are guesses at present - need to profile to get a
-  // real idea
-  progress->RegisterInternalFilter(m_Thresh, 0.1f);
-  progress->RegisterInternalFilter(m_Erode, 0.8f);
-  progress->RegisterInternalFilter(m_Sqrt, 0.1f);
+  progress->RegisterInternalFilter(m_Erode, 1.0f);
+  ParabolicShareThreadBudget(this, m_Erode);
 
   // std::cout << "DT" << std::endl;
 
@@ -98,29 +92,37 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::GenerateDa
   //       }
   //     }
   //   Wt = sqrt(Wt);
-  this->AllocateOutputs();
-
-  m_Thresh->SetLowerThreshold(m_OutsideValue);
-  m_Thresh->SetUpperThreshold(m_OutsideValue);
-  m_Thresh->SetOutsideValue(MaxDist);
-  m_Thresh->SetInsideValue(0);
-
-  m_Thresh->SetInput(this->GetInput());
-  m_Erode->SetInput(m_Thresh->GetOutput());
+  // The output is grafted from the erosion, so isn't allocated here.
 
+  // threshold the mask as the first pass reads it, and take the
+  // square root as the last pass writes the result
+  using LineRealType = typename ErodeType::RealType;
+  const auto outside = static_cast<LineRealType>(m_OutsideValue);
+  const auto maxDist = static_cast<LineRealType>(static_cast<OutputPixelType>(MaxDist));
+  m_Erode->SetPrologue(ParabolicPointwise<LineRealType>(
+    [outside, maxDist](const LineRealType v) { return v == outside ? LineRealType(0) : maxDist; }));
   if (m_SqrDist)
   {
-    m_Erode->GraftOutput(this->GetOutput());
-    m_Erode->Update();
-    this->GraftOutput(m_Erode->GetOutput());
+    m_Erode->SetEpilogue(nullptr);
   }
   else
   {
-    m_Sqrt->SetInput(m_Erode->GetOutput());
-    m_Sqrt->GraftOutput(this->GetOutput());
-    m_Sqrt->Update();
-    this->GraftOutput(m_Sqrt->GetOutput());
+    m_Erode->SetEpilogue(ParabolicPointwise<LineRealType>([](const LineRealType v) { return std::sqrt(v); }));
   }
+
+  m_Erode->SetInput(this->GetInput());
+  m_Erode->GraftOutput(this->GetOutput());
+  m_Erode->Update();
+  this->GraftOutput(m_Erode->GetOutput());
+}
+
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::EstimateCost(const SizeType &    size,
+                                                                                   const SpacingType & spacing) const
+{
+  // the threshold and square root are part of the erosion's passes
+  return m_Erode->EstimateCost(size, spacing);
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -130,6 +132,7 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::PrintSelf(
   Superclass::PrintSelf(os, indent);
   os << "Outside Value = " << (OutputPixelType)m_OutsideValue << std::endl;
   os << "ImageScale = " << m_Erode->GetUseImageSpacing() << std::endl;
+  os << "CheckpointFileName = " << m_Erode->GetCheckpointFileName() << std::endl;
 }
 } // namespace itk
 
@@ -33,8 +33,16 @@ namespace itk
  * structuring elements.
  *
  * This is an implemtentation of the method of Schavemaker for testing
- * the parabolic morphology routines. No particular efforts have been
- * made to minimize memory consumption.
+ * the parabolic morphology routines. The cast input is read by the
+ * erosion, the dilation and the sharpening operator, so it can't be
+ * overwritten, but the sharpening operator works in place on the
+ * dilation, saving one image of the output type per iteration.
+ *
+ * Every intermediate has the output pixel type, and the line kernels
+ * compute in its real type whatever it is. A 16-bit integer output
+ * type therefore halves the memory and bandwidth of the intermediates
+ * relative to float, at the cost of truncating to a whole grey level
+ * after every erosion or dilation pass.
  *
  *
  * \@article{Schavemaker2000,
@@ -138,6 +146,16 @@ public:
     return m_Erode->GetUseImageSpacing();
   }
 
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing.
+   * Every iteration repeats the erosion and dilation in the same
+   * buffers, so the memory doesn't grow with Iterations. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
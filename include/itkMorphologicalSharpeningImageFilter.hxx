@@ -19,6 +19,7 @@
 #define itkMorphologicalSharpeningImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 
@@ -33,6 +34,11 @@ MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::MorphologicalShar
   m_Dilate = DilateType::New();
   m_Cast = CastType::New();
   m_SharpenOp = SharpenOpType::New();
+  // the dilation has no other consumer
+  m_SharpenOp->InPlaceOn();
+  // nor has the erosion, so it goes once the sharpening operator has
+  // read it
+  m_Erode->ReleaseDataFlagOn();
   m_Iterations = 1;
   this->SetScale(1);
   this->SetUseImageSpacing(false);
@@ -46,8 +52,8 @@ MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::GenerateData()
 
   progress->SetMiniPipelineFilter(this);
 
-  // Allocate the output
-  this->AllocateOutputs();
+  // The output is grafted from the sharpening operator, which reuses
+  // the buffer of the dilation, so isn't allocated here.
 
   InputImageConstPointer inputImage = this->GetInput();
   m_Cast->SetInput(inputImage);
@@ -62,6 +68,10 @@ MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::GenerateData()
   progress->RegisterInternalFilter(m_Erode, 1.0f);
   progress->RegisterInternalFilter(m_Dilate, 1.0f);
   progress->RegisterInternalFilter(m_SharpenOp, 1.0f);
+  ParabolicShareThreadBudget(this, m_Cast);
+  ParabolicShareThreadBudget(this, m_Erode);
+  ParabolicShareThreadBudget(this, m_Dilate);
+  ParabolicShareThreadBudget(this, m_SharpenOp);
 
   // set up the progrss monitor
   // WatershedMiniPipelineProgressCommand::Pointer c =
@@ -87,9 +97,31 @@ MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::GenerateData()
     m_SharpenOp->GraftOutput(this->GetOutput());
     m_SharpenOp->Update();
     this->GraftOutput(m_SharpenOp->GetOutput());
+    if (i == 0)
+    {
+      // later iterations read the previous result instead
+      m_Cast->GetOutput()->ReleaseData();
+    }
   }
 }
 
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::EstimateCost(const SizeType &    size,
+                                                                            const SpacingType & spacing) const
+{
+  const auto pixels = static_cast<double>(typename TInputImage::RegionType(size).GetNumberOfPixels());
+
+  ParabolicCostEstimate stages = m_Erode->EstimateCost(size, spacing);
+  stages += m_Dilate->EstimateCost(size, spacing);
+
+  // the cast, then the sharpening operator in place on the dilation
+  ParabolicCostEstimate cost;
+  cost.PeakBytes = stages.PeakBytes + ParabolicImageBytes<OutputPixelType>(size);
+  cost.Operations = pixels + m_Iterations * (stages.Operations + pixels);
+  return cost;
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
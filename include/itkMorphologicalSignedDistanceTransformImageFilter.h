@@ -21,7 +21,6 @@
 #include "itkImageToImageFilter.h"
 #include "itkProgressReporter.h"
 
-#include "itkBinaryThresholdImageFilter.h"
 #include "itkParabolicErodeImageFilter.h"
 #include "itkParabolicDilateImageFilter.h"
 #include "itkMorphSDTHelperImageFilter.h"
@@ -54,6 +53,10 @@ namespace itk
  * Otherwise it is meant to have an interface to the other
  * DistanceTransforms filters.
  *
+ * The erosion and dilation threshold the mask as their first pass
+ * reads it, so the only images are theirs, and the combination of
+ * the two is written over the erosion.
+ *
  * Core methods described in the InsightJournal article:
  * "Morphology with parabolic structuring elements"
  *
@@ -156,6 +159,15 @@ public:
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing:
+   * the dilation, and the erosion, which becomes the output. */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing) const;
+
   const bool &
   GetUseImageSpacing()
   {
@@ -184,18 +196,18 @@ protected:
 
   int m_ParabolicAlgorithm;
 
-  // do everything in the output image type, which should have high precision
-  using ThreshType = typename itk::BinaryThresholdImageFilter<InputImageType, OutputImageType>;
-  using ErodeType = typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType>;
-  using DilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, OutputImageType>;
-  using HelperType = typename itk::MorphSDTHelperImageFilter<OutputImageType, OutputImageType>;
+  // the passes store their results in the output image type, which
+  // should have high precision
+  using ErodeType = typename itk::ParabolicErodeImageFilter<InputImageType, OutputImageType>;
+  using DilateType = typename itk::ParabolicDilateImageFilter<InputImageType, OutputImageType>;
+  using HelperType =
+    typename itk::MorphSDTHelperImageFilter<OutputImageType, OutputImageType, InputImageType, OutputImageType>;
 
 private:
   InputPixelType               m_OutsideValue;
   bool                         m_InsideIsPositive;
   typename ErodeType::Pointer  m_Erode;
   typename DilateType::Pointer m_Dilate;
-  typename ThreshType::Pointer m_Thresh;
   typename HelperType::Pointer m_Helper;
 };
 } // namespace itk
@@ -19,6 +19,7 @@
 #define itkMorphologicalSignedDistanceTransformImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
@@ -31,10 +32,13 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage,
 
   m_Erode = ErodeType::New();
   m_Dilate = DilateType::New();
-  m_Thresh = ThreshType::New();
   m_Helper = HelperType::New();
   m_Erode->SetScale(0.5);
   m_Dilate->SetScale(0.5);
+  // the helper takes over the buffer of the erosion, releasing the
+  // dilation when done
+  m_Dilate->ReleaseDataFlagOn();
+  m_Helper->InPlaceOn();
   this->SetUseImageSpacing(true);
   this->SetInsideIsPositive(false);
   m_OutsideValue = 0;
@@ -48,7 +52,6 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Modi
   Superclass::Modified();
   m_Erode->Modified();
   m_Dilate->Modified();
-  m_Thresh->Modified();
   m_Helper->Modified();
 }
 
@@ -61,15 +64,19 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Gene
   progress->SetMiniPipelineFilter(this);
   // these values are guesses at present - need to profile to get a
   // real idea
-  progress->RegisterInternalFilter(m_Thresh, 0.1f);
-  progress->RegisterInternalFilter(m_Erode, 0.4f);
-  progress->RegisterInternalFilter(m_Dilate, 0.4f);
+  progress->RegisterInternalFilter(m_Erode, 0.45f);
+  progress->RegisterInternalFilter(m_Dilate, 0.45f);
   progress->RegisterInternalFilter(m_Helper, 0.1f);
+  ParabolicShareThreadBudget(this, m_Erode);
+  ParabolicShareThreadBudget(this, m_Dilate);
+  ParabolicShareThreadBudget(this, m_Helper);
 
   m_Erode->SetParabolicAlgorithm(m_ParabolicAlgorithm);
   m_Dilate->SetParabolicAlgorithm(m_ParabolicAlgorithm);
 
-  this->AllocateOutputs();
+  // The output is grafted from the helper, which reuses the buffer of
+  // the erosion, so isn't allocated here.
+
   // figure out the maximum value of distance transform using the
   // image dimensions
   typename TOutputImage::SizeType    sz = this->GetOutput()->GetRequestedRegion().GetSize();
@@ -93,35 +100,55 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Gene
     }
   }
 
-  m_Thresh->SetLowerThreshold(m_OutsideValue);
-  m_Thresh->SetUpperThreshold(m_OutsideValue);
+  // both threshold the mask as their first pass reads it
+  using LineRealType = typename ErodeType::RealType;
+  const auto outside = static_cast<LineRealType>(m_OutsideValue);
+  auto       maxDist = static_cast<LineRealType>(static_cast<OutputPixelType>(MaxDist));
   if (this->GetInsideIsPositive())
   {
-    m_Thresh->SetOutsideValue(MaxDist);
-    m_Thresh->SetInsideValue(-MaxDist);
-  }
-  else
-  {
-    m_Thresh->SetOutsideValue(-MaxDist);
-    m_Thresh->SetInsideValue(MaxDist);
+    maxDist = -maxDist;
   }
+  const auto threshold = ParabolicPointwise<LineRealType>(
+    [outside, maxDist](const LineRealType v) { return v == outside ? maxDist : -maxDist; });
+  m_Erode->SetPrologue(threshold);
+  m_Dilate->SetPrologue(threshold);
+  m_Erode->SetInput(this->GetInput());
+  m_Dilate->SetInput(this->GetInput());
 
-  m_Thresh->SetInput(this->GetInput());
-  m_Erode->SetInput(m_Thresh->GetOutput());
-  m_Dilate->SetInput(m_Thresh->GetOutput());
-#if 1
+  // Only two images are live at once: the helper writes over the
+  // erosion. The sign comes from the input mask.
+  m_Erode->Update();
   m_Helper->SetInput(m_Erode->GetOutput());
   m_Helper->SetInput2(m_Dilate->GetOutput());
-  m_Helper->SetInput3(m_Thresh->GetOutput());
+  m_Helper->SetInput3(this->GetInput());
+  m_Helper->SetMaskValue(m_OutsideValue, !this->GetInsideIsPositive());
   m_Helper->SetVal(MaxDist);
-  m_Helper->GraftOutput(this->GetOutput());
   m_Helper->Update();
   this->GraftOutput(m_Helper->GetOutput());
-#else
-  m_Dilate->GraftOutput(this->GetOutput());
-  m_Dilate->Update();
-  this->GraftOutput(m_Dilate->GetOutput());
-#endif
+}
+
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::EstimateCost(
+  const SizeType &    size,
+  const SpacingType & spacing) const
+{
+  const auto pixels = static_cast<double>(typename TInputImage::RegionType(size).GetNumberOfPixels());
+
+  // GenerateData gives the erosion and dilation the algorithm
+  auto erode = ErodeType::New();
+  erode->SetScale(m_Erode->GetScale());
+  erode->SetUseImageSpacing(m_Erode->GetUseImageSpacing());
+  erode->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+  erode->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  // the erosion writes what becomes the output, the dilation costs
+  // the same
+  ParabolicCostEstimate cost = erode->EstimateCost(size, spacing);
+  cost += erode->EstimateCost(size, spacing);
+  // the helper, in place on the erosion
+  cost.Operations += pixels;
+  return cost;
 }
 
 template <typename TInputImage, typename TOutputImage>
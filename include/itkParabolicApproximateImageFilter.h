@@ -0,0 +1,228 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicApproximateImageFilter_h
+#define itkParabolicApproximateImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicApproximateImageFilter
+ * \brief Parabolic erosion, dilation, opening or closing at large
+ * scales, computed on a shrunken image within a bound on the error.
+ *
+ * At scales of hundreds of pixels (background estimation on large
+ * slides, for example) the result varies slowly, and computing it at
+ * every pixel is wasted effort. Like the shrink option of the ImageJ
+ * rolling ball, this filter reduces the input to the minimum (erosion
+ * and opening) or maximum (dilation and closing) of each block of
+ * ShrinkFactor pixels, applies the operation to the reduced image at
+ * its coarser spacing, and copies each result back to the pixels of
+ * its block.
+ *
+ * The difference from the exact result is bounded (see
+ * ParabolicShrinkError) by a function of the factors, the scale and
+ * the range of the values. By default the largest factors that keep
+ * the bound within MaximumError are chosen, sharing the error equally
+ * between the directions, and between the two stages of an opening or
+ * closing; directions with a zero scale are never shrunk. Explicit
+ * ShrinkFactors override the choice, and ErrorBound reports the bound
+ * for the factors used by the last update. The bound is for real
+ * values: integer output types add the rounding of each pass. The
+ * range is ValueRange when declared, the range of an integer pixel
+ * type, or else measured on the input.
+ *
+ * The shrunken image has factor^ImageDimension times fewer pixels. The
+ * intersection algorithm costs the same per pixel at any scale, so the
+ * saving is about that factor; the contact point algorithm also
+ * searches factor times fewer pixels per line. The whole input is
+ * requested. When every factor is 1 the exact filter runs on the input.
+ *
+ * \sa ParabolicErodeDilateImageFilter, ParabolicOpenCloseSafeBorderImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT ParabolicApproximateImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicApproximateImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicApproximateImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicApproximateImageFilter, ImageToImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using RegionType = typename TInputImage::RegionType;
+  using IndexType = typename TInputImage::IndexType;
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** a type to represent the "kernel radius" */
+  using RadiusType = typename itk::FixedArray<ScalarRealType, TInputImage::ImageDimension>;
+
+  /** a type to represent the block size along each direction */
+  using ShrinkFactorsType = FixedArray<unsigned int, TInputImage::ImageDimension>;
+
+  enum OperationType
+  {
+    ERODE = 0,
+    DILATE = 1,
+    OPEN = 2,
+    CLOSE = 3
+  };
+
+  /** Set/Get the operation approximated. Erosion is the default. */
+  itkSetMacro(Operation, int);
+  itkGetConstReferenceMacro(Operation, int);
+
+  // set all of the scales the same
+  void
+  SetScale(ScalarRealType scale)
+  {
+    RadiusType s;
+    s.Fill(scale);
+    this->SetScale(s);
+  }
+
+  itkSetMacro(Scale, RadiusType);
+  itkGetConstReferenceMacro(Scale, RadiusType);
+
+  /**
+   * Set/Get whether the scale refers to pixels or world units -
+   * default is false
+   */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+  enum ParabolicAlgorithmType
+  {
+    NOCHOICE = 0,     // decices based on scale - experimental
+    CONTACTPOINT = 1, // sometimes faster at low scale
+    INTERSECTION = 2  // default
+  };
+
+  /** Set/Get the algorithm of the passes, as for the exact filters. */
+  itkSetMacro(ParabolicAlgorithm, int);
+  itkGetConstReferenceMacro(ParabolicAlgorithm, int);
+
+  /**
+   * Set/Get the range (maximum - minimum) of the input values, used for
+   * the error bound. The default of 0 uses the range of the pixel type
+   * for integer pixels and measures the input otherwise.
+   */
+  itkSetMacro(ValueRange, ScalarRealType);
+  itkGetConstReferenceMacro(ValueRange, ScalarRealType);
+
+  /** Set/Get the largest difference from the exact result allowed
+   * when choosing the shrink factors. The default is 1. */
+  itkSetMacro(MaximumError, double);
+  itkGetConstReferenceMacro(MaximumError, double);
+
+  /** Set/Get the size of the blocks along each direction. 0 (the
+   * default) chooses the factor from MaximumError. */
+  itkSetMacro(ShrinkFactors, ShrinkFactorsType);
+  itkGetConstReferenceMacro(ShrinkFactors, ShrinkFactorsType);
+
+  /** The factors and the error bound of the last update. */
+  itkGetConstReferenceMacro(ShrinkFactorsUsed, ShrinkFactorsType);
+  itkGetConstMacro(ErrorBound, double);
+
+  /**
+   * Predict the peak memory and the work of an update with the current
+   * settings, for an input of the given size and spacing. The factors
+   * are chosen as an update would, but a range that would be measured
+   * on the input is taken as valueRange.
+   */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing, double valueRange = 0) const;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(SameDimension,
+                  (Concept::SameDimension<TInputImage::ImageDimension, TOutputImage::ImageDimension>));
+
+  itkConceptMacro(Comparable, (Concept::Comparable<PixelType>));
+
+  /** End concept checking */
+#endif
+protected:
+  ParabolicApproximateImageFilter();
+  ~ParabolicApproximateImageFilter() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateData() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+private:
+  /** Call f with a new exact filter for the operation. */
+  template <typename TFunction>
+  void
+  WithOperationFilter(TFunction && f) const;
+
+  /** Shrink factors for an input of the given size and spacing whose
+   * values span range, and the error bound they give. */
+  ShrinkFactorsType
+  ChooseShrinkFactors(const SizeType & size, const SpacingType & spacing, double range, double & bound) const;
+
+  int               m_Operation;
+  RadiusType        m_Scale;
+  bool              m_UseImageSpacing;
+  int               m_ParabolicAlgorithm;
+  ScalarRealType    m_ValueRange;
+  double            m_MaximumError;
+  ShrinkFactorsType m_ShrinkFactors;
+  ShrinkFactorsType m_ShrinkFactorsUsed;
+  double            m_ErrorBound;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicApproximateImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,378 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicApproximateImageFilter_hxx
+#define itkParabolicApproximateImageFilter_hxx
+
+#include <algorithm>
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressAccumulator.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+#include "itkParabolicCloseImageFilter.h"
+
+namespace itk
+{
+template <typename TInputImage, typename TOutputImage>
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::ParabolicApproximateImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(1);
+  this->SetNumberOfRequiredInputs(1);
+
+  m_Operation = ERODE;
+  m_Scale.Fill(1.0);
+  m_UseImageSpacing = false;
+  m_ParabolicAlgorithm = INTERSECTION;
+  m_ValueRange = 0;
+  m_MaximumError = 1.0;
+  m_ShrinkFactors.Fill(0);
+  m_ShrinkFactorsUsed.Fill(1);
+  m_ErrorBound = 0;
+}
+
+template <typename TInputImage, typename TOutputImage>
+template <typename TFunction>
+void
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::WithOperationFilter(TFunction && f) const
+{
+  switch (m_Operation)
+  {
+    case DILATE:
+      f(ParabolicDilateImageFilter<TInputImage, TOutputImage>::New());
+      break;
+    case OPEN:
+      f(ParabolicOpenImageFilter<TInputImage, TOutputImage>::New());
+      break;
+    case CLOSE:
+      f(ParabolicCloseImageFilter<TInputImage, TOutputImage>::New());
+      break;
+    default:
+      f(ParabolicErodeImageFilter<TInputImage, TOutputImage>::New());
+      break;
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+typename ParabolicApproximateImageFilter<TInputImage, TOutputImage>::ShrinkFactorsType
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::ChooseShrinkFactors(const SizeType &    size,
+                                                                                const SpacingType & spacing,
+                                                                                const double        range,
+                                                                                double &            bound) const
+{
+  // an opening or closing shrinks once, but both of its stages
+  // contribute an error
+  const unsigned int stages = (m_Operation == OPEN || m_Operation == CLOSE) ? 2 : 1;
+  const auto         pixelSigma = [this, &spacing](const unsigned int d) {
+    double sigma = m_Scale[d];
+    if (m_UseImageSpacing)
+    {
+      sigma /= spacing[d] * spacing[d];
+    }
+    return sigma;
+  };
+
+  ShrinkFactorsType factors;
+  double            explicitError = 0;
+  unsigned int      automatic = 0;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    const SizeValueType length = std::max<SizeValueType>(size[d], 1);
+    if (m_ShrinkFactors[d] > 0)
+    {
+      factors[d] = static_cast<unsigned int>(std::min<SizeValueType>(m_ShrinkFactors[d], length));
+      explicitError += ParabolicShrinkError(factors[d], pixelSigma(d), range, length);
+      continue;
+    }
+    factors[d] = 1;
+    // nothing bounds the error along a direction without a pass, or
+    // with an unknown range
+    if (pixelSigma(d) > 0 && range > 0)
+    {
+      ++automatic;
+    }
+  }
+
+  if (automatic > 0)
+  {
+    const double budget = (m_MaximumError / stages - explicitError) / automatic;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      const double        sigma = pixelSigma(d);
+      const SizeValueType length = std::max<SizeValueType>(size[d], 1);
+      if (m_ShrinkFactors[d] > 0 || !(sigma > 0))
+      {
+        continue;
+      }
+      // the error grows with the factor
+      while (factors[d] < length && ParabolicShrinkError(factors[d] + 1, sigma, range, length) <= budget)
+      {
+        ++factors[d];
+      }
+    }
+  }
+
+  bound = 0;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    bound += ParabolicShrinkError(factors[d], pixelSigma(d), range, std::max<SizeValueType>(size[d], 1));
+  }
+  bound *= stages;
+  return factors;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  // every block, and every pixel of the shrunken image, can influence
+  // every other
+  auto * image = const_cast<InputImageType *>(this->GetInput());
+  if (image)
+  {
+    image->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  auto * out = dynamic_cast<OutputImageType *>(output);
+  if (out)
+  {
+    out->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  if (m_Operation < ERODE || m_Operation > CLOSE)
+  {
+    itkExceptionMacro(<< "Unknown Operation " << m_Operation);
+  }
+
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+
+  const InputImageType * input = this->GetInput();
+  const RegionType       region = input->GetBufferedRegion();
+  const IndexType        start = region.GetIndex();
+
+  double range = m_ValueRange;
+  if (range <= 0)
+  {
+    range = ParabolicPixelTypeRange<PixelType>();
+  }
+  if (range <= 0)
+  {
+    PixelType minimum = NumericTraits<PixelType>::max();
+    PixelType maximum = NumericTraits<PixelType>::NonpositiveMin();
+    for (ImageRegionConstIterator<InputImageType> it(input, region); !it.IsAtEnd(); ++it)
+    {
+      minimum = std::min(minimum, it.Get());
+      maximum = std::max(maximum, it.Get());
+    }
+    range = std::max(0.0, static_cast<double>(maximum) - static_cast<double>(minimum));
+  }
+
+  m_ShrinkFactorsUsed = this->ChooseShrinkFactors(region.GetSize(), input->GetSpacing(), range, m_ErrorBound);
+  bool shrink = false;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    shrink = shrink || m_ShrinkFactorsUsed[d] > 1;
+  }
+
+  if (!shrink)
+  {
+    // the exact result is as cheap as it gets
+    auto localInput = TInputImage::New();
+    localInput->Graft(input);
+    this->WithOperationFilter([this, &progress, &localInput](auto filter) {
+      filter->SetInput(localInput);
+      filter->SetScale(m_Scale);
+      filter->SetUseImageSpacing(m_UseImageSpacing);
+      filter->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+      filter->SetValueRange(m_ValueRange);
+      progress->RegisterInternalFilter(filter, 1.0f);
+      ParabolicShareThreadBudget(this, filter);
+      filter->GraftOutput(this->GetOutput());
+      filter->Update();
+      this->GraftOutput(filter->GetOutput());
+    });
+    return;
+  }
+
+  this->AllocateOutputs();
+  const ShrinkFactorsType & factors = m_ShrinkFactorsUsed;
+
+  // The shrunken image covers the input with blocks, the last of which
+  // may be cut short. Each pixel sits at the centre of its block, so
+  // the shrunken image overlays the input in physical space.
+  SizeType                                coarseSize;
+  SpacingType                             coarseSpacing;
+  RadiusType                              coarseScale;
+  ContinuousIndex<double, ImageDimension> centre;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    coarseSize[d] = (region.GetSize(d) + factors[d] - 1) / factors[d];
+    coarseSpacing[d] = input->GetSpacing()[d] * factors[d];
+    // a pixel scale shrinks with the pixels
+    coarseScale[d] = m_UseImageSpacing ? m_Scale[d] : m_Scale[d] / (factors[d] * factors[d]);
+    centre[d] = start[d] + (factors[d] - 1) / 2.0;
+  }
+  typename InputImageType::PointType coarseOrigin;
+  input->TransformContinuousIndexToPhysicalPoint(centre, coarseOrigin);
+
+  auto coarse = InputImageType::New();
+  coarse->SetRegions(RegionType(coarseSize));
+  coarse->SetSpacing(coarseSpacing);
+  coarse->SetOrigin(coarseOrigin);
+  coarse->SetDirection(input->GetDirection());
+  coarse->Allocate();
+
+  // the extreme of each block that the first stage keeps
+  const bool takeMax = m_Operation == DILATE || m_Operation == CLOSE;
+  coarse->FillBuffer(takeMax ? NumericTraits<PixelType>::NonpositiveMin() : NumericTraits<PixelType>::max());
+  const auto blockOf = [&start, &factors](const IndexType & index) {
+    IndexType block;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      block[d] = (index[d] - start[d]) / static_cast<IndexValueType>(factors[d]);
+    }
+    return block;
+  };
+
+  ImageLinearConstIteratorWithIndex<InputImageType> inIt(input, region);
+  inIt.SetDirection(0);
+  inIt.GoToBegin();
+  while (!inIt.IsAtEnd())
+  {
+    PixelType * blocks = coarse->GetBufferPointer() + coarse->ComputeOffset(blockOf(inIt.GetIndex()));
+    for (SizeValueType i = 0; !inIt.IsAtEndOfLine(); ++i, ++inIt)
+    {
+      PixelType & b = blocks[i / factors[0]];
+      b = takeMax ? std::max(b, inIt.Get()) : std::min(b, inIt.Get());
+    }
+    inIt.NextLine();
+  }
+
+  typename OutputImageType::Pointer coarseResult;
+  this->WithOperationFilter([this, &progress, &coarse, &coarseScale, &coarseResult, range](auto filter) {
+    filter->SetInput(coarse);
+    filter->SetScale(coarseScale);
+    filter->SetUseImageSpacing(m_UseImageSpacing);
+    filter->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+    // the block extremes are within the range of the input
+    filter->SetValueRange(static_cast<ScalarRealType>(range));
+    progress->RegisterInternalFilter(filter, 1.0f);
+    ParabolicShareThreadBudget(this, filter);
+    filter->Update();
+    coarseResult = filter->GetOutput();
+  });
+
+  // copy each block result to the pixels of the block
+  OutputImageType *                             output = this->GetOutput();
+  ImageLinearIteratorWithIndex<OutputImageType> outIt(output, output->GetRequestedRegion());
+  outIt.SetDirection(0);
+  outIt.GoToBegin();
+  while (!outIt.IsAtEnd())
+  {
+    const OutputPixelType * blocks =
+      coarseResult->GetBufferPointer() + coarseResult->ComputeOffset(blockOf(outIt.GetIndex()));
+    for (SizeValueType i = 0; !outIt.IsAtEndOfLine(); ++i, ++outIt)
+    {
+      outIt.Set(blocks[i / factors[0]]);
+    }
+    outIt.NextLine();
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+ParabolicCostEstimate
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::EstimateCost(const SizeType &    size,
+                                                                         const SpacingType & spacing,
+                                                                         double              valueRange) const
+{
+  if (valueRange <= 0)
+  {
+    valueRange = m_ValueRange > 0 ? m_ValueRange : ParabolicPixelTypeRange<PixelType>();
+  }
+
+  double                  bound = 0;
+  const ShrinkFactorsType factors = this->ChooseShrinkFactors(size, spacing, valueRange, bound);
+  SizeType                coarseSize;
+  SpacingType             coarseSpacing;
+  RadiusType              coarseScale;
+  bool                    shrink = false;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    shrink = shrink || factors[d] > 1;
+    coarseSize[d] = (size[d] + factors[d] - 1) / factors[d];
+    coarseSpacing[d] = spacing[d] * factors[d];
+    coarseScale[d] = m_UseImageSpacing ? m_Scale[d] : m_Scale[d] / (factors[d] * factors[d]);
+  }
+
+  ParabolicCostEstimate cost;
+  this->WithOperationFilter([&](auto filter) {
+    filter->SetScale(coarseScale);
+    filter->SetUseImageSpacing(m_UseImageSpacing);
+    filter->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+    filter->SetValueRange(static_cast<ScalarRealType>(valueRange));
+    filter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    cost = filter->EstimateCost(coarseSize, coarseSpacing);
+  });
+  if (shrink)
+  {
+    // the shrunken input and the full output, each filled in one visit
+    // of every pixel
+    cost.PeakBytes += ParabolicImageBytes<PixelType>(coarseSize) + ParabolicImageBytes<OutputPixelType>(size);
+    cost.Operations += 2 * static_cast<double>(RegionType(size).GetNumberOfPixels());
+  }
+  return cost;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicApproximateImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Operation: " << m_Operation << std::endl;
+  if (m_UseImageSpacing)
+  {
+    os << indent << "Scale in world units: " << m_Scale << std::endl;
+  }
+  else
+  {
+    os << indent << "Scale in voxels: " << m_Scale << std::endl;
+  }
+  os << indent << "ParabolicAlgorithm: " << m_ParabolicAlgorithm << std::endl;
+  os << indent << "ValueRange: " << m_ValueRange << std::endl;
+  os << indent << "MaximumError: " << m_MaximumError << std::endl;
+  os << indent << "ShrinkFactors: " << m_ShrinkFactors << std::endl;
+  os << indent << "ShrinkFactorsUsed: " << m_ShrinkFactorsUsed << std::endl;
+  os << indent << "ErrorBound: " << m_ErrorBound << std::endl;
+}
+} // namespace itk
+
+#endif
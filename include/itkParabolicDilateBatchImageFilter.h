@@ -0,0 +1,82 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicDilateBatchImageFilter_h
+#define itkParabolicDilateBatchImageFilter_h
+
+#include "itkParabolicErodeDilateBatchImageFilter.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicDilateBatchImageFilter
+ * \brief Class for morphological dilation with parabolic structuring
+ * elements applied to many independent images in one update.
+ *
+ * Each input set with SetInput(i, image) produces output i, which is
+ * identical to the output of ParabolicDilateImageFilter applied to
+ * that input with the same settings.
+ *
+ * \sa itkParabolicErodeDilateBatchImageFilter
+ * \sa itkParabolicDilateImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ **/
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT ParabolicDilateBatchImageFilter
+  : public ParabolicErodeDilateBatchImageFilter<TInputImage, true, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicDilateBatchImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicDilateBatchImageFilter;
+  using Superclass = ParabolicErodeDilateBatchImageFilter<TInputImage, true, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicDilateBatchImageFilter, ParabolicErodeDilateBatchImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+
+  /** a type to represent the "kernel radius" */
+  using RadiusType = typename itk::FixedArray<ScalarRealType, TInputImage::ImageDimension>;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+protected:
+  ParabolicDilateBatchImageFilter() = default;
+  ~ParabolicDilateBatchImageFilter() override = default;
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicEngine_h
+#define itkParabolicEngine_h
+
+#include "itkNumericTraits.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicEngine
+ * \brief Reentrant parabolic erosion, dilation, opening and closing
+ * without a pipeline.
+ *
+ * The filters keep the state of an update (the pass being run, the
+ * stage of an opening) in member variables, so one instance can only
+ * run one update at a time. This class has no state at all: every
+ * method is static and works on the images it is given, in the calling
+ * thread. A service handling many requests can call it from all of its
+ * threads at once, provided each call has its own output image.
+ *
+ * The line buffers are either supplied by the caller or kept per
+ * thread, so a thread that handles many requests of similar size does
+ * not reallocate them.
+ *
+ * The whole buffered region of the input is processed. The output is
+ * given the information and buffered region of the input, and is only
+ * reallocated if its buffered region differs. Erode and Dilate give
+ * the same results as the filters with the same parameters. Open and
+ * Close do not pad the image, so they match ParabolicOpenCloseImageFilter
+ * rather than ParabolicOpenImageFilter and ParabolicCloseImageFilter
+ * with a safe border.
+ *
+ * \sa ParabolicErodeImageFilter ParabolicDilateImageFilter
+ * \sa ParabolicOpenCloseImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ **/
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT ParabolicEngine
+{
+public:
+  /** Standard class type alias. */
+  using Self = ParabolicEngine;
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  /** a type to represent the "kernel radius" */
+  using RadiusType = typename itk::FixedArray<ScalarRealType, TInputImage::ImageDimension>;
+
+  /** Line buffers for every direction */
+  using ScratchType = ParabolicLineScratchSet<RealType, TInputImage::ImageDimension>;
+
+  enum ParabolicAlgorithm
+  {
+    NOCHOICE = 0,     // decices based on scale - experimental
+    CONTACTPOINT = 1, // sometimes faster at low scale
+    INTERSECTION = 2  // default
+  };
+
+  /** The settings of one call, with the same meaning as the filter
+   * settings of the same name. */
+  struct Parameters
+  {
+    Parameters() { Scale.Fill(1); }
+
+    RadiusType Scale;
+    bool       UseImageSpacing{ false };
+    int        ParabolicAlgorithm{ INTERSECTION };
+  };
+
+  static void
+  Erode(const InputImageType & input, OutputImageType & output, const Parameters & parameters);
+  static void
+  Erode(const InputImageType & input, OutputImageType & output, const Parameters & parameters, ScratchType & scratch);
+
+  static void
+  Dilate(const InputImageType & input, OutputImageType & output, const Parameters & parameters);
+  static void
+  Dilate(const InputImageType & input, OutputImageType & output, const Parameters & parameters, ScratchType & scratch);
+
+  static void
+  Open(const InputImageType & input, OutputImageType & output, const Parameters & parameters);
+  static void
+  Open(const InputImageType & input, OutputImageType & output, const Parameters & parameters, ScratchType & scratch);
+
+  static void
+  Close(const InputImageType & input, OutputImageType & output, const Parameters & parameters);
+  static void
+  Close(const InputImageType & input, OutputImageType & output, const Parameters & parameters, ScratchType & scratch);
+
+  ParabolicEngine() = delete;
+
+private:
+  /** Line buffers owned by the calling thread. */
+  static ScratchType &
+  GetThreadScratch();
+
+  /** Give the output the geometry of the input. */
+  static void
+  PrepareOutput(const InputImageType & input, OutputImageType & output);
+
+  /** One erosion or dilation, reading from the input on the first pass
+   * when fromInput is set and from the output otherwise. */
+  template <bool doDilate>
+  static void
+  Run(const InputImageType & input,
+      OutputImageType &      output,
+      const Parameters &     parameters,
+      ScratchType &          scratch,
+      bool                   fromInput);
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicEngine.hxx"
+#endif
+
+#endif
@@ -0,0 +1,214 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicEngine_hxx
+#define itkParabolicEngine_hxx
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+
+namespace itk
+{
+template <typename TInputImage, typename TOutputImage>
+typename ParabolicEngine<TInputImage, TOutputImage>::ScratchType &
+ParabolicEngine<TInputImage, TOutputImage>::GetThreadScratch()
+{
+  thread_local ScratchType scratch;
+  return scratch;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::PrepareOutput(const InputImageType & input, OutputImageType & output)
+{
+  if (input.GetBufferPointer() == nullptr)
+  {
+    itkGenericExceptionMacro(<< "ParabolicEngine: the input image has no buffer");
+  }
+
+  output.CopyInformation(&input);
+  const typename InputImageType::RegionType & region = input.GetBufferedRegion();
+  if (output.GetBufferPointer() == nullptr || output.GetBufferedRegion() != region)
+  {
+    output.SetBufferedRegion(region);
+    output.Allocate();
+  }
+  output.SetRequestedRegion(region);
+}
+
+template <typename TInputImage, typename TOutputImage>
+template <bool doDilate>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Run(const InputImageType & input,
+                                                OutputImageType &      output,
+                                                const Parameters &     parameters,
+                                                ScratchType &          scratch,
+                                                bool                   fromInput)
+{
+  using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
+  using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
+  // for passes after the first
+  using OutputConstIteratorType = ImageLinearConstIteratorWithIndex<TOutputImage>;
+
+  const typename InputImageType::RegionType region = input.GetBufferedRegion();
+  const std::vector<unsigned int>           passAxes = ParabolicActiveAxes(parameters.Scale);
+
+  if (passAxes.empty())
+  {
+    if (fromInput)
+    {
+      // all scales are 0 - copy to output
+      ImageRegionConstIterator<TInputImage> InIt(&input, region);
+      ImageRegionIterator<TOutputImage>     OutIt(&output, region);
+      while (!InIt.IsAtEnd())
+      {
+        OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
+        ++InIt;
+        ++OutIt;
+      }
+    }
+    return;
+  }
+
+  scratch.SetNumberOfWorkUnits(1);
+  scratch.SetLineLengths(region.GetSize());
+  ParabolicNullProgress progress;
+
+  for (const unsigned int d : passAxes)
+  {
+    const long         LineLength = region.GetSize()[d];
+    const RealType     image_scale = input.GetSpacing()[d];
+    OutputIteratorType outputIterator(&output, region);
+    if (fromInput)
+    {
+      InputConstIteratorType inputIterator(&input, region);
+      doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+        inputIterator,
+        outputIterator,
+        progress,
+        LineLength,
+        d,
+        parameters.UseImageSpacing,
+        image_scale,
+        parameters.Scale[d],
+        parameters.ParabolicAlgorithm,
+        scratch.Get(0, d));
+      fromInput = false;
+    }
+    else
+    {
+      OutputConstIteratorType inputIterator(&output, region);
+      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+        inputIterator,
+        outputIterator,
+        progress,
+        LineLength,
+        d,
+        parameters.UseImageSpacing,
+        image_scale,
+        parameters.Scale[d],
+        parameters.ParabolicAlgorithm,
+        scratch.Get(0, d));
+    }
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Erode(const InputImageType & input,
+                                                  OutputImageType &      output,
+                                                  const Parameters &     parameters,
+                                                  ScratchType &          scratch)
+{
+  PrepareOutput(input, output);
+  Run<false>(input, output, parameters, scratch, true);
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Erode(const InputImageType & input,
+                                                  OutputImageType &      output,
+                                                  const Parameters &     parameters)
+{
+  Erode(input, output, parameters, GetThreadScratch());
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Dilate(const InputImageType & input,
+                                                   OutputImageType &      output,
+                                                   const Parameters &     parameters,
+                                                   ScratchType &          scratch)
+{
+  PrepareOutput(input, output);
+  Run<true>(input, output, parameters, scratch, true);
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Dilate(const InputImageType & input,
+                                                   OutputImageType &      output,
+                                                   const Parameters &     parameters)
+{
+  Dilate(input, output, parameters, GetThreadScratch());
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Open(const InputImageType & input,
+                                                 OutputImageType &      output,
+                                                 const Parameters &     parameters,
+                                                 ScratchType &          scratch)
+{
+  PrepareOutput(input, output);
+  Run<false>(input, output, parameters, scratch, true);
+  Run<true>(input, output, parameters, scratch, false);
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Open(const InputImageType & input,
+                                                 OutputImageType &      output,
+                                                 const Parameters &     parameters)
+{
+  Open(input, output, parameters, GetThreadScratch());
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Close(const InputImageType & input,
+                                                  OutputImageType &      output,
+                                                  const Parameters &     parameters,
+                                                  ScratchType &          scratch)
+{
+  PrepareOutput(input, output);
+  Run<true>(input, output, parameters, scratch, true);
+  Run<false>(input, output, parameters, scratch, false);
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+ParabolicEngine<TInputImage, TOutputImage>::Close(const InputImageType & input,
+                                                  OutputImageType &      output,
+                                                  const Parameters &     parameters)
+{
+  Close(input, output, parameters, GetThreadScratch());
+}
+} // namespace itk
+#endif
@@ -0,0 +1,202 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicErodeDilateBatchImageFilter_h
+#define itkParabolicErodeDilateBatchImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicErodeDilateBatchImageFilter
+ * \brief Parent class for parabolic erosion/dilation of many
+ * independent images in a single update.
+ *
+ * Pipelines that push large numbers of small images (2D slices,
+ * small 3D patches) through ParabolicErodeDilateImageFilter one at a
+ * time spend most of their time in per-call overhead: pipeline
+ * negotiation, output allocation and a multithreader fan-out/join for
+ * every axis. This filter accepts any number of indexed inputs, set
+ * with SetInput(i, image), and produces one output per input. All
+ * the line work is scheduled as a single parallel job - each work
+ * unit processes a contiguous block of whole images along every axis,
+ * reusing one set of line buffers, so there is one fan-out/join per
+ * update rather than one per axis per image.
+ *
+ * Inputs are processed independently and do not need to share
+ * origin, spacing or size, although throughput is best when they are
+ * the same size. The scale, spacing and algorithm options are the same
+ * as for ParabolicErodeDilateImageFilter and apply to every input.
+ *
+ * Images that are already stacked into a single (D+1)-dimensional
+ * image do not need this filter: use the regular filter with a scale
+ * of zero along the stacking axis, which is skipped entirely.
+ *
+ * Each image is handled by a single work unit, so this filter is
+ * only faster than the regular filter when there are at least as many
+ * images as work units.
+ *
+ * \sa ParabolicErodeDilateImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ **/
+template <typename TInputImage, bool doDilate, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT ParabolicErodeDilateBatchImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicErodeDilateBatchImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicErodeDilateBatchImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicErodeDilateBatchImageFilter, ImageToImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+
+  /** Smart pointer type alias support.  */
+  using InputImagePointer = typename TInputImage::Pointer;
+  using InputImageConstPointer = typename TInputImage::ConstPointer;
+  using InputSizeType = typename TInputImage::SizeType;
+
+  /** a type to represent the "kernel radius" */
+  using RadiusType = typename itk::FixedArray<ScalarRealType, TInputImage::ImageDimension>;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+  static constexpr unsigned int OutputImageDimension = TOutputImage::ImageDimension;
+  static constexpr unsigned int InputImageDimension = TInputImage::ImageDimension;
+
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  // set all of the scales the same
+  void
+  SetScale(ScalarRealType scale);
+
+  itkSetMacro(Scale, RadiusType);
+  itkGetConstReferenceMacro(Scale, RadiusType);
+
+  enum ParabolicAlgorithm
+  {
+    NOCHOICE = 0,     // decices based on scale - experimental
+    CONTACTPOINT = 1, // sometimes faster at low scale
+    INTERSECTION = 2  // default
+  };
+  /**
+   * Set/Get the method used. Choices are contact point or
+   * intersection. Intersection is the default. Contact point can be
+   * faster at small scales.
+   */
+  itkSetMacro(ParabolicAlgorithm, int);
+  itkGetConstReferenceMacro(ParabolicAlgorithm, int);
+
+  /**
+   * Set/Get whether the scale refers to pixels or world units -
+   * default is false
+   */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+  /** Set the i'th input. An output is created for every input. */
+  using Superclass::SetInput;
+  void
+  SetInput(unsigned int idx, const InputImageType * image) override;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(SameDimension,
+                  (Concept::SameDimension<itkGetStaticConstMacro(InputImageDimension),
+                                          itkGetStaticConstMacro(OutputImageDimension)>));
+
+  itkConceptMacro(Comparable, (Concept::Comparable<PixelType>));
+
+  /** End concept checking */
+#endif
+protected:
+  ParabolicErodeDilateBatchImageFilter();
+  ~ParabolicErodeDilateBatchImageFilter() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Each output takes its information from the matching input. */
+  void
+  GenerateOutputInformation() override;
+
+  /** Inputs are independent, so they are not required to share
+   * geometry. */
+  void
+  VerifyInputInformation() ITKv5_CONST override
+  {}
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  // Override since the filter produces the entire dataset.
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  /** Generate Data */
+  void
+  GenerateData() override;
+
+  /** Process the block of images assigned to one work unit. */
+  void
+  ThreadedGenerateBatch(ThreadIdType workUnit, ThreadIdType numberOfWorkUnits);
+
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  BatchThreaderCallback(void * arg);
+
+  bool m_UseImageSpacing;
+  int  m_ParabolicAlgorithm;
+
+private:
+  /** Make sure there is an output for every indexed input. */
+  void
+  MatchOutputsToInputs();
+
+  RadiusType m_Scale;
+
+  // line buffers for each work unit, kept between updates
+  ParabolicLineScratchSet<RealType, ImageDimension> m_LineScratch;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicErodeDilateBatchImageFilter.hxx"
+#endif
+
+#endif
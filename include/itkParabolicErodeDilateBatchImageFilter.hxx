@@ -0,0 +1,283 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicErodeDilateBatchImageFilter_hxx
+#define itkParabolicErodeDilateBatchImageFilter_hxx
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::ParabolicErodeDilateBatchImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(1);
+  this->SetNumberOfRequiredInputs(1);
+
+  m_UseImageSpacing = false;
+  m_ParabolicAlgorithm = INTERSECTION;
+  m_Scale.Fill(0);
+
+  this->DynamicMultiThreadingOff();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::SetScale(ScalarRealType scale)
+{
+  RadiusType s;
+
+  s.Fill(scale);
+  this->SetScale(s);
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::SetInput(unsigned int           idx,
+                                                                                   const InputImageType * image)
+{
+  Superclass::SetInput(idx, image);
+  this->MatchOutputsToInputs();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::MatchOutputsToInputs()
+{
+  const unsigned int numberOfImages = this->GetNumberOfIndexedInputs();
+
+  if (this->GetNumberOfIndexedOutputs() < numberOfImages)
+  {
+    this->SetNumberOfIndexedOutputs(numberOfImages);
+  }
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    if (this->GetOutput(i) == nullptr)
+    {
+      this->SetNthOutput(i, this->MakeOutput(i));
+    }
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::GenerateOutputInformation()
+{
+  this->MatchOutputsToInputs();
+
+  const unsigned int numberOfImages = this->GetNumberOfIndexedInputs();
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    const InputImageType * input = this->GetInput(i);
+    if (input == nullptr)
+    {
+      itkExceptionMacro(<< "Input " << i << " is not set");
+    }
+    this->GetOutput(i)->CopyInformation(input);
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::GenerateInputRequestedRegion()
+{
+  // This filter needs all of every input
+  const unsigned int numberOfImages = this->GetNumberOfIndexedInputs();
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    InputImagePointer image = const_cast<InputImageType *>(this->GetInput(i));
+    if (image)
+    {
+      image->SetRequestedRegion(image->GetLargestPossibleRegion());
+    }
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::EnlargeOutputRequestedRegion(DataObject *)
+{
+  const unsigned int numberOfOutputs = this->GetNumberOfIndexedOutputs();
+  for (unsigned int i = 0; i < numberOfOutputs; ++i)
+  {
+    OutputImageType * out = this->GetOutput(i);
+    if (out)
+    {
+      out->SetRequestedRegion(out->GetLargestPossibleRegion());
+    }
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::GenerateData()
+{
+  const unsigned int numberOfImages = this->GetNumberOfIndexedInputs();
+
+  this->AllocateOutputs();
+
+  // one work unit can't share an image with another, so there is no
+  // point starting more work units than images
+  ThreadIdType nbthreads = this->GetNumberOfWorkUnits();
+  nbthreads = std::min(nbthreads, static_cast<ThreadIdType>(numberOfImages));
+  nbthreads = std::max(nbthreads, static_cast<ThreadIdType>(1));
+  m_LineScratch.SetNumberOfWorkUnits(nbthreads);
+
+  itk::MultiThreaderBase * multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfWorkUnits(nbthreads);
+  multithreader->SetSingleMethod(this->BatchThreaderCallback, this);
+  multithreader->SingleMethodExecute();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::BatchThreaderCallback(void * arg)
+{
+  auto * workUnitInfo = static_cast<MultiThreaderBase::WorkUnitInfo *>(arg);
+  auto * filter = static_cast<Self *>(workUnitInfo->UserData);
+
+  filter->ThreadedGenerateBatch(workUnitInfo->WorkUnitID, workUnitInfo->NumberOfWorkUnits);
+
+  return ITK_THREAD_RETURN_DEFAULT_VALUE;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGenerateBatch(
+  ThreadIdType workUnit,
+  ThreadIdType numberOfWorkUnits)
+{
+  using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
+  using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
+  // for stages after the first
+  using OutputConstIteratorType = ImageLinearConstIteratorWithIndex<TOutputImage>;
+
+  // contiguous block of whole images for this work unit
+  const SizeValueType numberOfImages = this->GetNumberOfIndexedInputs();
+  const SizeValueType firstImage = (numberOfImages * workUnit) / numberOfWorkUnits;
+  const SizeValueType lastImage = (numberOfImages * (workUnit + 1)) / numberOfWorkUnits;
+
+  // directions with a zero scale are skipped entirely
+  const std::vector<unsigned int> passAxes = ParabolicActiveAxes(m_Scale);
+
+  // compute the number of rows first, so we can setup a progress reporter
+  SizeValueType numberOfRows = 0;
+  for (SizeValueType i = firstImage; i < lastImage; ++i)
+  {
+    const OutputImageRegionType & region = this->GetOutput(i)->GetRequestedRegion();
+    for (const unsigned int d : passAxes)
+    {
+      numberOfRows += region.GetNumberOfPixels() / std::max<SizeValueType>(region.GetSize()[d], 1);
+    }
+    if (passAxes.empty())
+    {
+      ++numberOfRows;
+    }
+  }
+
+  ProgressReporter progress(this, workUnit, numberOfRows, 30);
+
+  for (SizeValueType i = firstImage; i < lastImage; ++i)
+  {
+    const InputImageType *      inputImage = this->GetInput(i);
+    OutputImageType *           outputImage = this->GetOutput(i);
+    const OutputImageRegionType region = outputImage->GetRequestedRegion();
+
+    // the first pass reads from the input, later ones work in place
+    // on the output
+    bool first = true;
+    for (const unsigned int d : passAxes)
+    {
+      const unsigned long LineLength = region.GetSize()[d];
+      const RealType      image_scale = inputImage->GetSpacing()[d];
+      OutputIteratorType  outputIterator(outputImage, region);
+      // shared by every image processed by this work unit
+      ParabolicLineScratch<RealType> & scratch = m_LineScratch.Get(workUnit, d);
+      if (first)
+      {
+        InputConstIteratorType inputIterator(inputImage, region);
+        doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+          inputIterator,
+          outputIterator,
+          progress,
+          LineLength,
+          d,
+          this->m_UseImageSpacing,
+          image_scale,
+          this->m_Scale[d],
+          m_ParabolicAlgorithm,
+          scratch);
+        first = false;
+      }
+      else
+      {
+        OutputConstIteratorType inputIterator(outputImage, region);
+        doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+          inputIterator,
+          outputIterator,
+          progress,
+          LineLength,
+          d,
+          this->m_UseImageSpacing,
+          image_scale,
+          this->m_Scale[d],
+          m_ParabolicAlgorithm,
+          scratch);
+      }
+    }
+
+    if (passAxes.empty())
+    {
+      // all scales are 0 - copy to output
+      using InItType = ImageRegionConstIterator<TInputImage>;
+      using OutItType = ImageRegionIterator<TOutputImage>;
+
+      InItType  InIt(inputImage, region);
+      OutItType OutIt(outputImage, region);
+      while (!InIt.IsAtEnd())
+      {
+        OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
+        ++InIt;
+        ++OutIt;
+      }
+      progress.CompletedPixel();
+    }
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateBatchImageFilter<TInputImage, doDilate, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                    Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  if (m_UseImageSpacing)
+  {
+    os << "Scale in world units: " << m_Scale << std::endl;
+  }
+  else
+  {
+    os << "Scale in voxels: " << m_Scale << std::endl;
+  }
+  os << indent << "ParabolicAlgorithm: " << m_ParabolicAlgorithm << std::endl;
+}
+} // namespace itk
+#endif
@@ -18,9 +18,13 @@
 #ifndef itkParabolicErodeDilateImageFilter_h
 #define itkParabolicErodeDilateImageFilter_h
 
-#include "itkImageToImageFilter.h"
+#include <string>
+#include <vector>
+#include "itkImage.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
@@ -55,6 +59,75 @@ namespace itk
  * are cast back and forth between low and high precision types. Use a
  * high precision output type and cast manually if this is a problem.
  *
+ * Directions with a scale of zero are skipped entirely, so slice by
+ * slice processing of a volume (zero scale along z) costs the same as
+ * the in-plane passes alone, without an extra copy.
+ *
+ * Line buffers for every work unit are kept between updates. When the
+ * same filter is applied to many images of the same size (the frames
+ * of a time series, for example), turn off the
+ * ReleaseDataBeforeUpdateFlag as well so that the output buffer is
+ * reused too, and the updates after the first do not allocate.
+ *
+ * Because the passes are independent, images too large for one
+ * machine can be distributed by slab. Each process runs this filter on
+ * its slab with a zero scale along the slab axis, the intermediate
+ * results are exchanged so that each process owns a slab across a
+ * different axis, and each process then runs the filter with a scale
+ * only along the first slab axis. The result is identical to
+ * processing the whole image. The exchange itself (MPI all-to-all, for
+ * example) is left to the application; itkParaSlabTest shows the
+ * decomposition.
+ *
+ * A value can only travel a limited distance along each direction:
+ * ceil(sqrt(2 * scale * range)) pixels, where range is the difference
+ * between the largest and smallest input value (the scale is divided
+ * by the squared spacing when UseImageSpacing is on). When the range
+ * is known - declared with SetValueRange, or taken from an integer
+ * pixel type - the input requested region is only padded by that
+ * distance, so region of interest queries and streaming pipelines pay
+ * for the part of the image they use. The passes compute the margin in
+ * a buffer of their own, since its pixels are not exact, and the
+ * output buffered region is the requested region. Otherwise whole
+ * lines along the directions with a non zero scale are requested, and
+ * the filter still streams across directions with a zero scale.
+ * Volumes larger than memory can be processed in two streamed stages:
+ * a reader, this filter with a zero scale along z and a streaming
+ * writer (SetNumberOfStreamDivisions) producing an intermediate file
+ * in slabs along z; then a reader of that file, this filter with a
+ * scale only along z and a writer streaming across y (for example a
+ * StreamingImageFilter with an ImageRegionSplitterDirection that does
+ * not split z). Choose the number of divisions so that one slab of the
+ * input and output fits in the memory budget. Both files need a format
+ * that supports streamed reading and writing, such as MetaImage or
+ * NRRD. itkParaStreamTest shows the recipe.
+ *
+ * Every pass after the first reads back from the output, and the
+ * first reads each line whole before writing it, so the input buffer
+ * can become the output. With InPlaceOn() and identical input and
+ * output image types the filter does this, halving the memory needed,
+ * and the input is released afterwards. In place operation is off by
+ * default.
+ *
+ * Lines that are all one value, such as the background of a sparse
+ * mask, are not passed through the line kernel each time: the result
+ * for such a line is computed once per work unit and copied, and in
+ * the passes that work in place a line the kernel leaves unchanged
+ * (a line of zeros in a distance transform, for example) is not
+ * written back at all. The results are identical to processing every
+ * line.
+ *
+ * An optional MaskImage, with the geometry of the input, restricts the
+ * filter to its non zero pixels: the others take no part in any pass
+ * and keep their input values in the output (they are not written at
+ * all when running in place). Each line is gathered from the samples
+ * inside the mask, so lines wholly outside it are skipped. Along a
+ * line the gaps are simply left out of the envelope, so a value can
+ * cross them; between passes, a value reaches a pixel through the
+ * corners of the separable path, which must be inside the mask. The
+ * masked passes always use the intersection algorithm, and a border
+ * and an output stride are not supported with a mask.
+ *
  * Boomgaard, R. van den and Dorst, L. and Makram-Ebeid, L.S. and
  * Schavemaker, J. Quadratic structuring functions in mathematical
  * morphology. Mathematical Morphology and its Applications to Image
@@ -80,14 +153,14 @@ namespace itk
  **/
 
 template <typename TInputImage, bool doDilate, typename TOutputImage = TInputImage>
-class ITK_TEMPLATE_EXPORT ParabolicErodeDilateImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+class ITK_TEMPLATE_EXPORT ParabolicErodeDilateImageFilter : public InPlaceImageFilter<TInputImage, TOutputImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(ParabolicErodeDilateImageFilter);
 
   /** Standard class type alias. */
   using Self = ParabolicErodeDilateImageFilter;
-  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Superclass = InPlaceImageFilter<TInputImage, TOutputImage>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
@@ -95,7 +168,7 @@ public:
   itkNewMacro(Self);
 
   /** Runtime information support. */
-  itkTypeMacro(ParabolicErodeDilateImageFilter, ImageToImageFilter);
+  itkTypeMacro(ParabolicErodeDilateImageFilter, InPlaceImageFilter);
 
   /** Pixel Type of the input image */
   using InputImageType = TInputImage;
@@ -159,6 +232,216 @@ public:
   itkSetMacro(UseImageSpacing, bool);
   itkGetConstReferenceMacro(UseImageSpacing, bool);
   itkBooleanMacro(UseImageSpacing);
+
+  /** a type to represent the order in which directions are processed */
+  using AxisOrderType = FixedArray<unsigned int, TInputImage::ImageDimension>;
+
+  /**
+   * Set/Get the order in which the directions are processed. Must be
+   * a permutation of 0..ImageDimension-1. The default is increasing
+   * order, which processes the contiguous direction first. When the
+   * intermediate cache is in use, put the directions whose scale is
+   * changed most often last.
+   */
+  itkSetMacro(AxisOrder, AxisOrderType);
+  itkGetConstReferenceMacro(AxisOrder, AxisOrderType);
+
+  /**
+   * Set/Get whether the result of each pass is kept so that later
+   * updates can restart from the first pass whose settings changed.
+   * For example, after changing only the scale of the last direction
+   * in AxisOrder, only that direction is recomputed. The cache is
+   * invalidated by changes to the input, its geometry, the spacing
+   * option or the algorithm. This costs one extra image per pass
+   * (less the last) and is off by default. It is not used with a mask.
+   */
+  itkSetMacro(UseIntermediateCache, bool);
+  itkGetConstReferenceMacro(UseIntermediateCache, bool);
+  itkBooleanMacro(UseIntermediateCache);
+
+  /** Discard any cached intermediate results. */
+  void
+  ReleaseIntermediateCache();
+
+  /** Number of passes the last update took from the intermediate
+   * cache rather than computing. */
+  itkGetConstMacro(NumberOfCachedPassesUsed, unsigned int);
+
+  /**
+   * Set/Get a file to checkpoint long runs to. After each pass but the
+   * last, the result so far is written next to it (CheckpointFileName
+   * with .0 or .1 appended, alternately) and a manifest describing it
+   * is written to CheckpointFileName itself. An update that finds a
+   * manifest matching its output region, spacing, settings and the
+   * axes and scales of its leading passes loads that result and
+   * carries on from the next pass, so a job killed part way through
+   * (by a node preemption, for example) only redoes the pass it was
+   * in. Replacing the manifest is the last step of a checkpoint, so a
+   * job killed while writing one resumes from the one before.
+   *
+   * The mask is recorded by a digest of where it is set, but the input
+   * and the prologue are not: resume with the same ones. Data is
+   * stored in the byte order of the machine, and takes up to two
+   * output images of disk. The files are removed once the
+   * last pass completes. Passes work in place, so a pass is the unit
+   * of recovery. An empty name (the default) disables checkpoints.
+   */
+  itkSetStringMacro(CheckpointFileName);
+  itkGetStringMacro(CheckpointFileName);
+
+  /** Number of passes the last update loaded from a checkpoint rather
+   * than computing. */
+  itkGetConstMacro(NumberOfResumedPasses, unsigned int);
+
+  /** The pass being processed, counting from 0. Progress observers
+   * can use it to act between passes. */
+  itkGetConstMacro(CurrentPass, unsigned int);
+
+  /**
+   * Set/Get the number of pixels at or below which the filter runs in
+   * the calling thread instead of dispatching work units for every
+   * direction. For small images (interactive previews, for example)
+   * the thread setup dominates the cost of the filter. The default is
+   * 256x256 pixels; set it to 0 to always use the threaded path.
+   */
+  itkSetMacro(SmallImageThreshold, SizeValueType);
+  itkGetConstReferenceMacro(SmallImageThreshold, SizeValueType);
+
+  /**
+   * Set/Get the range (maximum - minimum) of the input values, used to
+   * bound the region of the input needed for a requested output
+   * region. The default of 0 uses the range of the pixel type for
+   * integer pixels and requests whole lines for floating point
+   * pixels. Declaring a range smaller than the real one gives
+   * incorrect results near the edges of a requested region.
+   */
+  itkSetMacro(ValueRange, ScalarRealType);
+  itkGetConstReferenceMacro(ValueRange, ScalarRealType);
+
+  /** a type to represent the output sample spacing, in input pixels */
+  using StrideType = FixedArray<unsigned int, TInputImage::ImageDimension>;
+
+  /**
+   * Set/Get the output stride: the output keeps every OutputStride[d]-th
+   * sample along each direction d, starting with the first, as
+   * morphological pooling for a multiscale pyramid does. The result
+   * equals eroding or dilating and then subsampling, with the spacing
+   * multiplied by the stride, but each pass writes only the samples it
+   * keeps, so later passes have fewer lines, and the intersection
+   * algorithm only evaluates the envelope at the kept samples.
+   * Directions with a stride but a zero scale are decimated first.
+   * Each pass writes a new, smaller image, so the filter does not run
+   * in place, and the whole input is requested. A border, the
+   * intermediate cache and checkpoints are not supported with a
+   * stride. The default, 1 along every direction, keeps every sample.
+   */
+  itkSetMacro(OutputStride, StrideType);
+  itkGetConstReferenceMacro(OutputStride, StrideType);
+  void
+  SetOutputStride(unsigned int stride)
+  {
+    StrideType s;
+    s.Fill(stride);
+    this->SetOutputStride(s);
+  }
+
+  using OutputPixelContainerType = typename OutputImageType::PixelContainer;
+
+  /**
+   * Set/Get a pixel container to use as the output buffer instead of
+   * allocating one, for example a ParabolicMappedImageContainer so
+   * that the result is written straight to a file. It must hold at
+   * least the pixels of the output requested region, and takes
+   * precedence over running in place. Null (the default) allocates as
+   * usual.
+   */
+  itkSetObjectMacro(OutputPixelContainer, OutputPixelContainerType);
+  itkGetModifiableObjectMacro(OutputPixelContainer, OutputPixelContainerType);
+
+  /**
+   * Set/Get a virtual border. The output covers the input plus
+   * BorderPadLowerBound pixels below and BorderPadUpperBound pixels
+   * above along every direction, with the same values as padding the
+   * input with BorderValue (ConstantPadImageFilter) would give, but
+   * the padded input is never built: the first pass extends each line
+   * as it is read. SetBorderPad sets both sides. BorderValue should lie
+   * within ValueRange. The default, 0, adds no border.
+   */
+  itkSetMacro(BorderPadLowerBound, InputSizeType);
+  itkGetConstReferenceMacro(BorderPadLowerBound, InputSizeType);
+  itkSetMacro(BorderPadUpperBound, InputSizeType);
+  itkGetConstReferenceMacro(BorderPadUpperBound, InputSizeType);
+  void
+  SetBorderPad(const InputSizeType & pad)
+  {
+    this->SetBorderPadLowerBound(pad);
+    this->SetBorderPadUpperBound(pad);
+  }
+  itkSetMacro(BorderValue, PixelType);
+  itkGetConstReferenceMacro(BorderValue, PixelType);
+
+  using SpacingType = typename TInputImage::SpacingType;
+
+  using MaskImageType = Image<unsigned char, TInputImage::ImageDimension>;
+
+  /** Set/Get the mask restricting the filter to its non zero pixels.
+   * Null (the default) processes every pixel. */
+  itkSetInputMacro(MaskImage, MaskImageType);
+  itkGetInputMacro(MaskImage, MaskImageType);
+
+  using LineFunctionType = ParabolicLineFunction<RealType>;
+
+  /**
+   * Set/Get a function applied to every line of the input as the first
+   * pass reads it, before the line kernel, and one applied to every
+   * line of the result as the last pass writes it. They take the
+   * place of pointwise filters before and after this one (a threshold
+   * before a distance transform, a square root after it) without the
+   * extra passes over memory; ParabolicPointwise builds one from a
+   * function of a single value. Both work on RealType values, and the
+   * output type must be able to hold the values between passes. The
+   * BorderValue goes through the prologue like the input. Declare a
+   * ValueRange for the values the prologue produces, otherwise whole
+   * lines are requested. Empty functions (the default) do nothing.
+   */
+  void
+  SetPrologue(const LineFunctionType & prologue)
+  {
+    m_LineFunctions.Prologue = prologue;
+    // cached passes were computed with the old prologue
+    this->ReleaseIntermediateCache();
+    this->Modified();
+  }
+  const LineFunctionType &
+  GetPrologue() const
+  {
+    return m_LineFunctions.Prologue;
+  }
+  void
+  SetEpilogue(const LineFunctionType & epilogue)
+  {
+    m_LineFunctions.Epilogue = epilogue;
+    this->Modified();
+  }
+  const LineFunctionType &
+  GetEpilogue() const
+  {
+    return m_LineFunctions.Epilogue;
+  }
+
+  /**
+   * Predict the peak memory and the work of an update with the current
+   * settings, for an input of the given size and spacing, without
+   * running the filter. The output buffer is not counted when it is a
+   * caller supplied container or the input (running in place), and
+   * the intermediate cache adds one image per pass but the last. The
+   * contact point algorithm is charged for its search over ValueRange.
+   * With a MaskImage there is no cache and the intersection algorithm
+   * is used, but the work is an upper bound: lines or samples outside
+   * the mask are charged as if they were inside.
+   */
+  ParabolicCostEstimate
+  EstimateCost(const InputSizeType & size, const SpacingType & spacing) const;
   /** Image related type alias. */
 
 #ifdef ITK_USE_CONCEPT_CHECKING
@@ -187,10 +470,30 @@ protected:
   void
   ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
 
+  /** Process the current pass over a region, using the line buffers
+   * of the given work unit. */
+  void
+  GeneratePass(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId);
+
+  void
+  GenerateOutputInformation() override;
+
   void
   GenerateInputRequestedRegion() override;
 
-  // Override since the filter produces the entire dataset.
+  // a strided output is smaller than the input, and a margin needs a
+  // buffer larger than the output
+  bool
+  CanRunInPlace() const override;
+
+  // the declared value range, or the range of the pixel type, or 0 if
+  // neither is known
+  double
+  GetInfluenceRange() const;
+
+  // Override since the filter produces whole lines along every
+  // direction with a non zero scale when the range is unknown. A
+  // margin is not added to the output, since its pixels are not exact.
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
@@ -198,9 +501,88 @@ protected:
   int  m_ParabolicAlgorithm;
 
 private:
-  RadiusType m_Scale;
+  /** True if any direction has an output stride above 1 */
+  bool
+  IsStrided() const;
+
+  /** The output requested region with the margin the passes must
+   * compute for it to be exact. */
+  OutputImageRegionType
+  GetPassRegion() const;
+
+  /** Number of leading passes of the current plan that are still
+   * valid in the intermediate cache. */
+  unsigned int
+  GetNumberOfCachedPasses() const;
+
+  /** The checkpoint of the first passes of the current plan, as its
+   * manifest records it. */
+  std::string
+  MakeCheckpointManifest(unsigned int passes, const std::string & dataFile) const;
+
+  std::string
+  GetCheckpointDataFileName(unsigned int passes) const;
+
+  /** Load the output from a checkpoint matching the current plan, and
+   * return the number of passes it holds, or 0 if there is none. */
+  unsigned int
+  ResumeFromCheckpoint();
+
+  void
+  WriteCheckpoint(unsigned int passes);
+
+  void
+  RemoveCheckpoint() const;
+
+  RadiusType     m_Scale;
+  AxisOrderType  m_AxisOrder;
+  bool           m_UseIntermediateCache;
+  SizeValueType  m_SmallImageThreshold;
+  ScalarRealType m_ValueRange;
+  StrideType     m_OutputStride;
+
+  typename OutputPixelContainerType::Pointer m_OutputPixelContainer;
+  InputSizeType                              m_BorderPadLowerBound;
+  InputSizeType                              m_BorderPadUpperBound;
+  PixelType                                  m_BorderValue;
+  ParabolicLineFunctions<RealType>           m_LineFunctions;
+  std::string                                m_CheckpointFileName;
+  std::uint64_t                              m_CheckpointMaskDigest;
+  unsigned int                               m_NumberOfResumedPasses;
+  unsigned int                               m_NumberOfCachedPassesUsed;
+
+  // line buffers for each work unit, kept between updates
+  ParabolicLineScratchSet<RealType, ImageDimension> m_LineScratch;
+
+  // result after each pass, and the settings it was computed with
+  using OutputImagePointer = typename TOutputImage::Pointer;
+  std::vector<OutputImagePointer> m_PassCache;
+  std::vector<unsigned int>       m_CachedPassAxes;
+  std::vector<ScalarRealType>     m_CachedPassScales;
+  const InputImageType *          m_CachedInput;
+  ModifiedTimeType                m_CachedInputTime;
+  OutputImageRegionType           m_CachedRegion;
+  SpacingType                     m_CachedSpacing;
+  bool                            m_CachedUseImageSpacing;
+  int                             m_CachedParabolicAlgorithm;
+  InputSizeType                   m_CachedBorderPadLowerBound;
+  InputSizeType                   m_CachedBorderPadUpperBound;
+  PixelType                       m_CachedBorderValue;
+
+  // the image the passes write: the output, or a buffer that also
+  // holds the margin around the requested region
+  OutputImagePointer m_PassImage;
+
+  // with an output stride, the image the current pass reads (the
+  // input for the first pass) and the one it writes
+  OutputImagePointer m_PassSource;
+  OutputImagePointer m_PassDestination;
 
-  int m_CurrentDimension;
+  // directions processed, in order, and the one currently being
+  // processed. ImageDimension means a plain copy.
+  std::vector<unsigned int> m_PassAxes;
+  unsigned int              m_CurrentPass;
+  unsigned int              m_CurrentDimension;
 };
 } // end namespace itk
 
@@ -18,6 +18,7 @@
 #ifndef itkParabolicErodeDilateImageFilter_hxx
 #define itkParabolicErodeDilateImageFilter_hxx
 
+#include "itkImageAlgorithm.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 
@@ -30,6 +31,13 @@
 #  include "itkImageLinearConstIterator.h"
 #endif
 #include "itkParabolicMorphUtils.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
 
 namespace itk
 {
@@ -38,10 +46,36 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ParabolicE
 {
   this->SetNumberOfRequiredOutputs(1);
   this->SetNumberOfRequiredInputs(1);
+  this->AddOptionalInputName("MaskImage", 1);
 
   m_UseImageSpacing = false;
   m_ParabolicAlgorithm = INTERSECTION;
+  m_Scale.Fill(0);
+  m_CurrentDimension = 0;
+  m_CurrentPass = 0;
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    m_AxisOrder[d] = d;
+  }
+  m_UseIntermediateCache = false;
+  m_CachedInput = nullptr;
+  m_CachedInputTime = 0;
+  m_CachedUseImageSpacing = false;
+  m_CachedParabolicAlgorithm = NOCHOICE;
+  m_SmallImageThreshold = 256 * 256;
+  m_ValueRange = 0;
+  m_OutputStride.Fill(1);
+  m_BorderPadLowerBound.Fill(0);
+  m_BorderPadUpperBound.Fill(0);
+  m_BorderValue = NumericTraits<PixelType>::ZeroValue();
+  m_CachedBorderPadLowerBound.Fill(0);
+  m_CachedBorderPadUpperBound.Fill(0);
+  m_CachedBorderValue = NumericTraits<PixelType>::ZeroValue();
+  m_NumberOfResumedPasses = 0;
+  m_CheckpointMaskDigest = 0;
+  m_NumberOfCachedPassesUsed = 0;
 
+  this->InPlaceOff();
   this->DynamicMultiThreadingOff();
 }
 
@@ -55,8 +89,11 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SplitReque
   // Get the output pointer
   OutputImageType * outputPtr = this->GetOutput();
 
-  // Initialize the splitRegion to the output requested region
-  splitRegion = outputPtr->GetRequestedRegion();
+  // Initialize the splitRegion to the region the current pass writes:
+  // the image of a strided pass, or the output requested region with
+  // its margin
+  const OutputImageType * passImage = m_PassDestination ? m_PassDestination.GetPointer() : m_PassImage.GetPointer();
+  splitRegion = passImage ? passImage->GetBufferedRegion() : outputPtr->GetRequestedRegion();
 
   const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
 
@@ -114,6 +151,46 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SetScale(S
   this->SetScale(s);
 }
 
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  // a virtual border extends the output beyond the input
+  OutputImageType * out = this->GetOutput();
+  if (out && ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+  {
+    out->SetLargestPossibleRegion(
+      ParabolicPadRegion(out->GetLargestPossibleRegion(), m_BorderPadLowerBound, m_BorderPadUpperBound));
+  }
+
+  if (out && this->IsStrided())
+  {
+    if (ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+    {
+      itkExceptionMacro(<< "A border is not supported with an OutputStride");
+    }
+    // Output sample i along d is input sample start + (i - start) *
+    // stride, so the region keeps its start index, and the origin
+    // moves to keep that sample where it was.
+    OutputImageRegionType                  region = out->GetLargestPossibleRegion();
+    typename OutputImageType::SpacingType  spacing = out->GetSpacing();
+    typename OutputImageType::SpacingType  shift;
+    typename OutputImageType::PointType    origin = out->GetOrigin();
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      region.SetSize(d, ParabolicStridedLength(region.GetSize(d), m_OutputStride[d]));
+      shift[d] = spacing[d] * (1.0 - m_OutputStride[d]) * region.GetIndex(d);
+      spacing[d] *= m_OutputStride[d];
+    }
+    origin += out->GetDirection() * shift;
+    out->SetLargestPossibleRegion(region);
+    out->SetSpacing(spacing);
+    out->SetOrigin(origin);
+  }
+}
+
 #if 1
 template <typename TInputImage, bool doDilate, typename TOutputImage>
 void
@@ -123,11 +200,53 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GenerateIn
   // copy the output requested region to the input requested region
   Superclass::GenerateInputRequestedRegion();
 
-  // This filter needs all of the input
   InputImagePointer image = const_cast<InputImageType *>(this->GetInput());
+  auto *            mask = const_cast<MaskImageType *>(this->GetMaskImage());
+  if (this->IsStrided())
+  {
+    // the output regions don't map onto input regions index for index
+    if (image)
+    {
+      image->SetRequestedRegionToLargestPossibleRegion();
+    }
+    if (mask)
+    {
+      mask->SetRequestedRegionToLargestPossibleRegion();
+    }
+    return;
+  }
+  if (image && ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+  {
+    // the border part of the output needs no input
+    typename InputImageType::RegionType region = image->GetRequestedRegion();
+    if (!region.Crop(image->GetLargestPossibleRegion()))
+    {
+      // only border is requested, but the input must still be valid
+      region = image->GetLargestPossibleRegion();
+    }
+    image->SetRequestedRegion(region);
+  }
+
+  // The passes compute a margin of the influence radius around the
+  // output requested region, or whole lines, so the input and mask are
+  // needed over it too
   if (image)
   {
-    image->SetRequestedRegion(this->GetInput()->GetLargestPossibleRegion());
+    image->SetRequestedRegion(ParabolicEnlargeByInfluence(image->GetRequestedRegion(),
+                                                          image->GetLargestPossibleRegion(),
+                                                          m_Scale,
+                                                          image->GetSpacing(),
+                                                          m_UseImageSpacing,
+                                                          this->GetInfluenceRange()));
+  }
+  if (mask)
+  {
+    mask->SetRequestedRegion(ParabolicEnlargeByInfluence(mask->GetRequestedRegion(),
+                                                         mask->GetLargestPossibleRegion(),
+                                                         m_Scale,
+                                                         mask->GetSpacing(),
+                                                         m_UseImageSpacing,
+                                                         this->GetInfluenceRange()));
   }
 }
 
@@ -139,12 +258,71 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::EnlargeOut
 {
   auto * out = dynamic_cast<TOutputImage *>(output);
 
-  if (out)
+  if (out && this->IsStrided())
   {
-    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+    out->SetRequestedRegionToLargestPossibleRegion();
+  }
+  else if (out && this->GetInfluenceRange() <= 0)
+  {
+    // whole lines are exact throughout
+    out->SetRequestedRegion(
+      ParabolicEnlargeAlongActiveAxes(out->GetRequestedRegion(), out->GetLargestPossibleRegion(), m_Scale));
   }
 }
 
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+bool
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::CanRunInPlace() const
+{
+  // a border makes the output larger than the input buffer
+  return Superclass::CanRunInPlace() && !this->IsStrided() &&
+         !ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound) &&
+         this->GetPassRegion() == this->GetOutput()->GetRequestedRegion();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+typename ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::OutputImageRegionType
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GetPassRegion() const
+{
+  const OutputImageType * out = this->GetOutput();
+  return ParabolicEnlargeByInfluence(out->GetRequestedRegion(),
+                                     out->GetLargestPossibleRegion(),
+                                     m_Scale,
+                                     out->GetSpacing(),
+                                     m_UseImageSpacing,
+                                     this->GetInfluenceRange());
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+bool
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::IsStrided() const
+{
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    if (m_OutputStride[d] > 1)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+double
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GetInfluenceRange() const
+{
+  if (m_ValueRange > 0)
+  {
+    return static_cast<double>(m_ValueRange);
+  }
+  if (m_LineFunctions.Prologue)
+  {
+    // the prologue can map the input to any range
+    return 0;
+  }
+  return ParabolicPixelTypeRange<PixelType>();
+}
+
 #endif
 
 template <typename TInputImage, bool doDilate, typename TOutputImage>
@@ -156,24 +334,416 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GenerateDa
   typename TInputImage::ConstPointer inputImage(this->GetInput());
   typename TOutputImage::Pointer     outputImage(this->GetOutput());
 
-  // const unsigned int imageDimension = inputImage->GetImageDimension();
-  outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
-  outputImage->Allocate();
+  m_NumberOfCachedPassesUsed = 0;
+  const bool masked = this->GetMaskImage() != nullptr;
+  if (masked && (this->IsStrided() || ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound)))
+  {
+    itkExceptionMacro(<< "A border and an OutputStride are not supported with a MaskImage");
+  }
+
+  // grafts the input to the output when running in place
+  if (!ParabolicUseOutputContainer(outputImage.GetPointer(), m_OutputPixelContainer.GetPointer()))
+  {
+    this->AllocateOutputs();
+  }
+
+  // The pixels in the margin around the requested region are not
+  // exact, so the passes compute them in a buffer of their own, and
+  // the output keeps only the requested region.
+  const OutputImageRegionType passRegion =
+    this->IsStrided() ? outputImage->GetRequestedRegion() : this->GetPassRegion();
+  m_PassImage = outputImage;
+  if (passRegion != outputImage->GetRequestedRegion())
+  {
+    m_PassImage = OutputImageType::New();
+    m_PassImage->CopyInformation(outputImage);
+    m_PassImage->SetRegions(passRegion);
+    m_PassImage->Allocate();
+  }
+
+  // Small images are processed in this thread. Dispatching a
+  // multithreader per pass costs more than the passes themselves.
+  // A strided pass reads more than the output holds.
+  const SizeValueType pixels =
+    this->IsStrided() ? inputImage->GetBufferedRegion().GetNumberOfPixels() : passRegion.GetNumberOfPixels();
+  const bool          singleThreaded = nbthreads == 1 || pixels <= m_SmallImageThreshold;
 
   // Set up the multithreaded processing
   typename ImageSource<OutputImageType>::ThreadStruct str;
   str.Filter = this;
 
   itk::MultiThreaderBase * multithreader = this->GetMultiThreader();
-  multithreader->SetNumberOfWorkUnits(nbthreads);
-  multithreader->SetSingleMethod(this->ThreaderCallback, &str);
+  if (!singleThreaded)
+  {
+    multithreader->SetNumberOfWorkUnits(nbthreads);
+    multithreader->SetSingleMethod(this->ThreaderCallback, &str);
+  }
+  // line buffers are sized here, so the work units never allocate
+  m_LineScratch.SetNumberOfWorkUnits(singleThreaded ? 1 : nbthreads);
+  m_LineScratch.SetLineLengths(passRegion.GetSize());
 
-  // multithread the execution
+  auto executePass = [&]() {
+    if (singleThreaded)
+    {
+      this->GeneratePass(m_PassDestination ? m_PassDestination->GetBufferedRegion() : passRegion, 0);
+    }
+    else
+    {
+      multithreader->SingleMethodExecute();
+    }
+  };
+
+  AxisOrderType sortedOrder = m_AxisOrder;
+  std::sort(sortedOrder.begin(), sortedOrder.end());
   for (unsigned int d = 0; d < ImageDimension; d++)
   {
-    m_CurrentDimension = d;
-    multithreader->SingleMethodExecute();
+    if (sortedOrder[d] != d)
+    {
+      itkExceptionMacro(<< "AxisOrder " << m_AxisOrder << " is not a permutation of the image directions");
+    }
+  }
+
+  if (this->IsStrided())
+  {
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      if (m_OutputStride[d] == 0)
+      {
+        itkExceptionMacro(<< "OutputStride " << m_OutputStride << " must be at least 1 along every direction");
+      }
+    }
+    // each pass reads whole lines of its source and writes a new image
+    // decimated along its direction, the last one the output
+    this->ReleaseIntermediateCache();
+    m_PassAxes = ParabolicStridedAxes(m_Scale, m_OutputStride, m_AxisOrder);
+    m_LineScratch.SetLineLengths(inputImage->GetBufferedRegion().GetSize());
+    OutputImageRegionType passRegion = inputImage->GetBufferedRegion();
+    for (unsigned int p = 0; p < m_PassAxes.size(); p++)
+    {
+      const unsigned int d = m_PassAxes[p];
+      m_CurrentPass = p;
+      m_CurrentDimension = d;
+      passRegion.SetSize(d, ParabolicStridedLength(passRegion.GetSize(d), m_OutputStride[d]));
+      if (p + 1 < m_PassAxes.size())
+      {
+        m_PassDestination = OutputImageType::New();
+        m_PassDestination->CopyInformation(outputImage);
+        m_PassDestination->SetRegions(passRegion);
+        m_PassDestination->Allocate();
+      }
+      else
+      {
+        m_PassDestination = outputImage;
+      }
+      executePass();
+      // the previous source is released here
+      m_PassSource = m_PassDestination;
+    }
+    m_PassSource = nullptr;
+    m_PassDestination = nullptr;
+    m_PassImage = nullptr;
+    return;
+  }
+
+  // multithread the execution, one pass per direction with a non
+  // zero scale
+  m_PassAxes = ParabolicActiveAxes(m_Scale, m_AxisOrder);
+  if (m_PassAxes.empty())
+  {
+    // all scales are 0 - a single pass copies the input
+    m_CurrentPass = 0;
+    m_CurrentDimension = ImageDimension;
+    executePass();
+    m_PassImage = nullptr;
+    return;
+  }
+
+  unsigned int firstPass = 0;
+  // the cache doesn't record the mask
+  if (m_UseIntermediateCache && !masked)
+  {
+    // restart from the result of the last pass that is still valid
+    firstPass = this->GetNumberOfCachedPasses();
+    m_NumberOfCachedPassesUsed = firstPass;
+    if (firstPass > 0)
+    {
+      const OutputImageType * cached = m_PassCache[firstPass - 1];
+      std::copy_n(cached->GetBufferPointer(), passRegion.GetNumberOfPixels(), m_PassImage->GetBufferPointer());
+    }
+    m_PassCache.resize(m_PassAxes.size() - 1);
+    m_CachedPassAxes.resize(firstPass);
+    m_CachedPassScales.resize(firstPass);
+    m_CachedInput = inputImage.GetPointer();
+    m_CachedInputTime = std::max(inputImage->GetMTime(), inputImage->GetUpdateMTime());
+    m_CachedRegion = passRegion;
+    m_CachedSpacing = inputImage->GetSpacing();
+    m_CachedUseImageSpacing = m_UseImageSpacing;
+    m_CachedParabolicAlgorithm = m_ParabolicAlgorithm;
+    m_CachedBorderPadLowerBound = m_BorderPadLowerBound;
+    m_CachedBorderPadUpperBound = m_BorderPadUpperBound;
+    m_CachedBorderValue = m_BorderValue;
+  }
+  else
+  {
+    this->ReleaseIntermediateCache();
+  }
+
+  bool cachePasses = m_UseIntermediateCache && !masked;
+  m_NumberOfResumedPasses = 0;
+  // the checkpoint records which mask its passes were computed with
+  m_CheckpointMaskDigest = 0;
+  if (masked && !m_CheckpointFileName.empty())
+  {
+    m_CheckpointMaskDigest = ParabolicMaskDigest(this->GetMaskImage(), passRegion);
+  }
+  if (!m_CheckpointFileName.empty() && firstPass == 0)
+  {
+    // a restarted job carries on after the last pass it completed
+    m_NumberOfResumedPasses = this->ResumeFromCheckpoint();
+    if (m_NumberOfResumedPasses > 0)
+    {
+      firstPass = m_NumberOfResumedPasses;
+      // the passes before it can't be cached
+      this->ReleaseIntermediateCache();
+      cachePasses = false;
+    }
+  }
+
+  for (unsigned int p = firstPass; p < m_PassAxes.size(); p++)
+  {
+    m_CurrentPass = p;
+    m_CurrentDimension = m_PassAxes[p];
+    executePass();
+
+    // the last pass is the output, so it isn't checkpointed
+    if (!m_CheckpointFileName.empty() && p + 1 < m_PassAxes.size())
+    {
+      this->WriteCheckpoint(p + 1);
+    }
+
+    // or cached
+    if (cachePasses && p + 1 < m_PassAxes.size())
+    {
+      if (!m_PassCache[p])
+      {
+        m_PassCache[p] = OutputImageType::New();
+      }
+      m_PassCache[p]->CopyInformation(outputImage);
+      m_PassCache[p]->SetRegions(passRegion);
+      m_PassCache[p]->Allocate();
+      std::copy_n(m_PassImage->GetBufferPointer(), passRegion.GetNumberOfPixels(), m_PassCache[p]->GetBufferPointer());
+      m_CachedPassAxes.push_back(m_CurrentDimension);
+      m_CachedPassScales.push_back(m_Scale[m_CurrentDimension]);
+    }
+  }
+
+  if (m_PassImage != outputImage)
+  {
+    ImageAlgorithm::Copy(m_PassImage.GetPointer(),
+                         outputImage.GetPointer(),
+                         outputImage->GetRequestedRegion(),
+                         outputImage->GetRequestedRegion());
+  }
+  m_PassImage = nullptr;
+
+  if (!m_CheckpointFileName.empty())
+  {
+    this->RemoveCheckpoint();
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+unsigned int
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GetNumberOfCachedPasses() const
+{
+  const InputImageType * inputImage = this->GetInput();
+
+  if (m_CachedInput != inputImage ||
+      m_CachedInputTime != std::max(inputImage->GetMTime(), inputImage->GetUpdateMTime()) ||
+      m_CachedRegion != m_PassImage->GetBufferedRegion() || m_CachedSpacing != inputImage->GetSpacing() ||
+      m_CachedUseImageSpacing != m_UseImageSpacing || m_CachedParabolicAlgorithm != m_ParabolicAlgorithm ||
+      m_CachedBorderPadLowerBound != m_BorderPadLowerBound || m_CachedBorderPadUpperBound != m_BorderPadUpperBound ||
+      Math::NotExactlyEquals(m_CachedBorderValue, m_BorderValue))
+  {
+    return 0;
+  }
+
+  // the last pass is never cached
+  const size_t maxPasses = std::min(m_CachedPassAxes.size(), m_PassAxes.size() - 1);
+  unsigned int passes = 0;
+  while (passes < maxPasses && m_CachedPassAxes[passes] == m_PassAxes[passes] &&
+         m_CachedPassScales[passes] == m_Scale[m_PassAxes[passes]])
+  {
+    ++passes;
+  }
+  return passes;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+std::string
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::MakeCheckpointManifest(
+  unsigned int        passes,
+  const std::string & dataFile) const
+{
+  const OutputImageRegionType & region = m_PassImage->GetBufferedRegion();
+  const SpacingType &           spacing = this->GetInput()->GetSpacing();
+
+  std::ostringstream manifest;
+  manifest << std::setprecision(std::numeric_limits<double>::max_digits10);
+  manifest << "ParabolicCheckpoint = 1\n"
+           << "Operation = " << (doDilate ? "dilate" : "erode") << "\n"
+           << "PixelBytes = " << sizeof(OutputPixelType) << "\n"
+           << "Region =";
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    manifest << ' ' << region.GetIndex(d) << ' ' << region.GetSize(d);
+  }
+  manifest << "\nSpacing =";
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    manifest << ' ' << static_cast<double>(spacing[d]);
+  }
+  manifest << "\nBorderPad =";
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    manifest << ' ' << m_BorderPadLowerBound[d] << ' ' << m_BorderPadUpperBound[d];
+  }
+  manifest << "\nBorderValue = " << static_cast<typename NumericTraits<PixelType>::PrintType>(m_BorderValue) << "\n"
+           << "UseImageSpacing = " << m_UseImageSpacing << "\n"
+           << "ParabolicAlgorithm = " << m_ParabolicAlgorithm << "\n"
+           << "Mask = ";
+  if (this->GetMaskImage())
+  {
+    manifest << std::hex << m_CheckpointMaskDigest << std::dec;
+  }
+  else
+  {
+    manifest << "none";
+  }
+  manifest << "\nAxes =";
+  for (unsigned int p = 0; p < passes; ++p)
+  {
+    manifest << ' ' << m_PassAxes[p];
+  }
+  manifest << "\nScales =";
+  for (unsigned int p = 0; p < passes; ++p)
+  {
+    manifest << ' ' << static_cast<double>(m_Scale[m_PassAxes[p]]);
+  }
+  manifest << "\nDataFile = " << dataFile << "\n";
+  return manifest.str();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+std::string
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GetCheckpointDataFileName(
+  unsigned int passes) const
+{
+  // successive checkpoints alternate, so the one the manifest names is
+  // never the one being written
+  return m_CheckpointFileName + (passes % 2 ? ".1" : ".0");
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+unsigned int
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ResumeFromCheckpoint()
+{
+  std::ifstream manifestFile(m_CheckpointFileName.c_str());
+  if (!manifestFile)
+  {
+    return 0;
+  }
+  const std::string manifest((std::istreambuf_iterator<char>(manifestFile)), std::istreambuf_iterator<char>());
+
+  OutputImageType *    outputImage = m_PassImage;
+  const std::streamoff bytes =
+    static_cast<std::streamoff>(outputImage->GetBufferedRegion().GetNumberOfPixels() * sizeof(OutputPixelType));
+
+  // the last pass is never checkpointed
+  for (auto passes = static_cast<unsigned int>(m_PassAxes.size() - 1); passes > 0; --passes)
+  {
+    const std::string dataFile = this->GetCheckpointDataFileName(passes);
+    if (manifest != this->MakeCheckpointManifest(passes, dataFile))
+    {
+      continue;
+    }
+    // check the size before reading, since the output may be the
+    // input when running in place
+    std::ifstream data(dataFile.c_str(), std::ios::binary | std::ios::ate);
+    if (!data || static_cast<std::streamoff>(data.tellg()) != bytes)
+    {
+      itkWarningMacro(<< "Checkpoint data " << dataFile
+                      << " is missing or the wrong size, starting from the first pass");
+      return 0;
+    }
+    data.seekg(0);
+    data.read(reinterpret_cast<char *>(outputImage->GetBufferPointer()), bytes);
+    if (!data)
+    {
+      itkExceptionMacro(<< "Cannot read checkpoint data " << dataFile);
+    }
+    return passes;
   }
+  itkDebugMacro(<< "Checkpoint " << m_CheckpointFileName << " does not match the current settings");
+  return 0;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::WriteCheckpoint(unsigned int passes)
+{
+  const OutputImageType * outputImage = m_PassImage;
+  const std::string       dataFile = this->GetCheckpointDataFileName(passes);
+
+  std::ofstream data(dataFile.c_str(), std::ios::binary | std::ios::trunc);
+  data.write(reinterpret_cast<const char *>(outputImage->GetBufferPointer()),
+             static_cast<std::streamsize>(outputImage->GetBufferedRegion().GetNumberOfPixels() *
+                                          sizeof(OutputPixelType)));
+  data.close();
+  if (!data)
+  {
+    itkExceptionMacro(<< "Cannot write checkpoint data " << dataFile);
+  }
+
+  const std::string newManifest = m_CheckpointFileName + ".tmp";
+  std::ofstream     manifest(newManifest.c_str(), std::ios::trunc);
+  manifest << this->MakeCheckpointManifest(passes, dataFile);
+  manifest.close();
+  if (!manifest)
+  {
+    itkExceptionMacro(<< "Cannot write checkpoint manifest " << newManifest);
+  }
+
+  // Replacing the manifest commits the checkpoint. Until then it names
+  // the previous data file, which is untouched.
+#if defined(_WIN32)
+  std::remove(m_CheckpointFileName.c_str());
+#endif
+  if (std::rename(newManifest.c_str(), m_CheckpointFileName.c_str()) != 0)
+  {
+    itkExceptionMacro(<< "Cannot replace checkpoint manifest " << m_CheckpointFileName);
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::RemoveCheckpoint() const
+{
+  // the manifest first, so that a job killed here doesn't find it
+  // naming a removed data file
+  std::remove(m_CheckpointFileName.c_str());
+  std::remove(this->GetCheckpointDataFileName(0).c_str());
+  std::remove(this->GetCheckpointDataFileName(1).c_str());
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ReleaseIntermediateCache()
+{
+  m_PassCache.clear();
+  m_CachedPassAxes.clear();
+  m_CachedPassScales.clear();
+  m_CachedInput = nullptr;
 }
 
 template <typename TInputImage, bool doDilate, typename TOutputImage>
@@ -181,6 +751,15 @@ void
 ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGenerateData(
   const OutputImageRegionType & outputRegionForThread,
   ThreadIdType                  threadId)
+{
+  this->GeneratePass(outputRegionForThread, threadId);
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GeneratePass(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
 {
   // compute the number of rows first, so we can setup a progress reporter
   unsigned int  numberOfRows = 1;
@@ -194,10 +773,10 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGe
     }
   }
 
-  float progressPerDimension = 1.0 / ImageDimension;
+  float progressPerDimension = 1.0 / std::max<size_t>(m_PassAxes.size(), 1);
 
   ProgressReporter progress(
-    this, threadId, numberOfRows, 30, m_CurrentDimension * progressPerDimension, progressPerDimension);
+    this, threadId, numberOfRows, 30, m_CurrentPass * progressPerDimension, progressPerDimension);
 
   using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
   using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
@@ -208,76 +787,339 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGe
   using RegionType = ImageRegion<TInputImage::ImageDimension>;
 
   typename TInputImage::ConstPointer inputImage(this->GetInput());
-  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+  // the output, or the buffer holding the margin too
+  typename TOutputImage::Pointer outputImage(m_PassImage);
 
-  // outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  // outputImage->Allocate();
   RegionType region = outputRegionForThread;
 
-  InputConstIteratorType  inputIterator(inputImage, region);
-  OutputIteratorType      outputIterator(outputImage, region);
-  OutputConstIteratorType inputIteratorStage2(outputImage, region);
+  // the prologue belongs to the pass that reads the input, the
+  // epilogue to the one that writes the result
+  ParabolicLineFunctions<RealType> functions;
+  if (m_CurrentPass == 0)
+  {
+    functions.Prologue = m_LineFunctions.Prologue;
+  }
+  if (m_CurrentPass + 1 >= m_PassAxes.size())
+  {
+    functions.Epilogue = m_LineFunctions.Epilogue;
+  }
 
-  // deal with the first dimension - this should be copied to the
-  // output if the scale is 0
-  if (m_CurrentDimension == 0)
+  if (m_PassDestination)
   {
-    if (m_Scale[0] > 0)
-    {
-      // Perform as normal
-      // RealType magnitude = 1.0/(2.0 * m_Scale[0]);
-      unsigned long LineLength = region.GetSize()[0];
-      RealType      image_scale = this->GetInput()->GetSpacing()[0];
+    // region is part of the image this strided pass writes. The source
+    // has the same lines, at their full length along the direction.
+    const unsigned int d = m_CurrentDimension;
+    RegionType         sourceRegion = region;
+    const RegionType & source =
+      m_CurrentPass == 0 ? inputImage->GetBufferedRegion() : m_PassSource->GetBufferedRegion();
+    sourceRegion.SetIndex(d, source.GetIndex(d));
+    sourceRegion.SetSize(d, source.GetSize(d));
 
+    OutputIteratorType               destinationIterator(m_PassDestination, region);
+    ParabolicLineScratch<RealType> & scratch = m_LineScratch.Get(threadId, d);
+    const RealType                   image_scale = inputImage->GetSpacing()[d];
+    if (m_CurrentPass == 0)
+    {
+      InputConstIteratorType sourceIterator(inputImage, sourceRegion);
       doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
-        inputIterator,
-        outputIterator,
+        sourceIterator,
+        destinationIterator,
         progress,
-        LineLength,
-        0,
+        sourceRegion.GetSize(d),
+        d,
         this->m_UseImageSpacing,
         image_scale,
-        this->m_Scale[0],
-        m_ParabolicAlgorithm);
+        this->m_Scale[d],
+        m_ParabolicAlgorithm,
+        scratch,
+        ParabolicLineBorder<RealType>(),
+        functions,
+        m_OutputStride[d]);
     }
     else
     {
-      // copy to output
-      using InItType = ImageRegionConstIterator<TInputImage>;
-      using OutItType = ImageRegionIterator<TOutputImage>;
+      OutputConstIteratorType sourceIterator(m_PassSource, sourceRegion);
+      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+        sourceIterator,
+        destinationIterator,
+        progress,
+        sourceRegion.GetSize(d),
+        d,
+        this->m_UseImageSpacing,
+        image_scale,
+        this->m_Scale[d],
+        m_ParabolicAlgorithm,
+        scratch,
+        ParabolicLineBorder<RealType>(),
+        functions,
+        m_OutputStride[d]);
+    }
+    return;
+  }
 
-      InItType  InIt(inputImage, region);
-      OutItType OutIt(outputImage, region);
-      while (!InIt.IsAtEnd())
+  if (m_CurrentPass == 0 && ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+  {
+    const unsigned int d = m_CurrentDimension;
+    ParabolicFirstPassWithBorder<TInputImage, TOutputImage, RealType, doDilate>(
+      inputImage.GetPointer(),
+      outputImage.GetPointer(),
+      region,
+      progress,
+      d,
+      this->m_UseImageSpacing,
+      d < ImageDimension ? this->m_Scale[d] : 0,
+      m_ParabolicAlgorithm,
+      m_LineScratch.Get(threadId, std::min(d, ImageDimension - 1)),
+      m_BorderValue,
+      functions);
+    return;
+  }
+
+  if (const MaskImageType * mask = this->GetMaskImage())
+  {
+    // a copy pass only applies the functions
+    const unsigned int d = std::min(m_CurrentDimension, ImageDimension - 1);
+    const RealType     sigma = m_CurrentDimension < ImageDimension ? this->m_Scale[d] : 0;
+    const RealType     image_scale = inputImage->GetSpacing()[d];
+
+    ImageLinearConstIteratorWithIndex<MaskImageType> maskIterator(mask, region);
+    OutputIteratorType                               outputIterator(outputImage, region);
+    ParabolicLineScratch<RealType> &                 scratch = m_LineScratch.Get(threadId, d);
+    if (m_CurrentPass == 0)
+    {
+      // outside the mask the output keeps the input, which is already
+      // there when running in place
+      const bool copyOutside = static_cast<const void *>(inputImage->GetBufferPointer()) !=
+                               static_cast<const void *>(outputImage->GetBufferPointer());
+      InputConstIteratorType inputIterator(inputImage, region);
+      doOneDimensionMasked<InputConstIteratorType,
+                           OutputIteratorType,
+                           ImageLinearConstIteratorWithIndex<MaskImageType>,
+                           RealType,
+                           doDilate>(inputIterator,
+                                     outputIterator,
+                                     maskIterator,
+                                     progress,
+                                     d,
+                                     this->m_UseImageSpacing,
+                                     image_scale,
+                                     sigma,
+                                     copyOutside,
+                                     scratch,
+                                     functions);
+    }
+    else
+    {
+      OutputConstIteratorType inputIterator(outputImage, region);
+      doOneDimensionMasked<OutputConstIteratorType,
+                           OutputIteratorType,
+                           ImageLinearConstIteratorWithIndex<MaskImageType>,
+                           RealType,
+                           doDilate>(inputIterator,
+                                     outputIterator,
+                                     maskIterator,
+                                     progress,
+                                     d,
+                                     this->m_UseImageSpacing,
+                                     image_scale,
+                                     sigma,
+                                     false,
+                                     scratch,
+                                     functions);
+    }
+    return;
+  }
+
+  if (m_CurrentDimension == ImageDimension && !functions.Empty())
+  {
+    // copy to output a line at a time, through the functions
+    ParabolicLineScratch<RealType> & scratch = m_LineScratch.Get(threadId, 0);
+    scratch.SetLineLength(region.GetSize(0));
+
+    InputConstIteratorType inputIterator(inputImage, region);
+    OutputIteratorType     outputIterator(outputImage, region);
+    inputIterator.SetDirection(0);
+    outputIterator.SetDirection(0);
+    inputIterator.GoToBegin();
+    outputIterator.GoToBegin();
+    for (; !inputIterator.IsAtEnd(); inputIterator.NextLine(), outputIterator.NextLine())
+    {
+      for (SizeValueType i = 0; !inputIterator.IsAtEndOfLine(); ++i, ++inputIterator)
+      {
+        scratch.LineBuf[i] = static_cast<RealType>(inputIterator.Get());
+      }
+      if (functions.Prologue)
       {
-        OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
-        ++InIt;
-        ++OutIt;
+        functions.Prologue(scratch.LineBuf.data_block(), scratch.LineBuf.size());
       }
+      ParabolicWriteLine(outputIterator, scratch.LineBuf, scratch, functions);
     }
+    return;
+  }
+
+  if (m_CurrentDimension == ImageDimension)
+  {
+    // copy to output
+    using InItType = ImageRegionConstIterator<TInputImage>;
+    using OutItType = ImageRegionIterator<TOutputImage>;
+
+    InItType  InIt(inputImage, region);
+    OutItType OutIt(outputImage, region);
+    while (!InIt.IsAtEnd())
+    {
+      OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
+      ++InIt;
+      ++OutIt;
+    }
+    return;
+  }
+
+  OutputIteratorType               outputIterator(outputImage, region);
+  ParabolicLineScratch<RealType> & scratch = m_LineScratch.Get(threadId, m_CurrentDimension);
+
+  unsigned long LineLength = region.GetSize()[m_CurrentDimension];
+  RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
+
+  // the first pass reads from the input, the others work in place on
+  // the output
+  if (m_CurrentPass == 0)
+  {
+    InputConstIteratorType inputIterator(inputImage, region);
+
+    doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      m_CurrentDimension,
+      this->m_UseImageSpacing,
+      image_scale,
+      this->m_Scale[m_CurrentDimension],
+      m_ParabolicAlgorithm,
+      scratch,
+      ParabolicLineBorder<RealType>(),
+      functions);
   }
   else
   {
-    // other dimensions
-    if (m_Scale[m_CurrentDimension] > 0)
+    OutputConstIteratorType inputIteratorStage2(outputImage, region);
+
+    doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
+      inputIteratorStage2,
+      outputIterator,
+      progress,
+      LineLength,
+      m_CurrentDimension,
+      this->m_UseImageSpacing,
+      image_scale,
+      this->m_Scale[m_CurrentDimension],
+      m_ParabolicAlgorithm,
+      scratch,
+      ParabolicLineBorder<RealType>(),
+      functions);
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+ParabolicCostEstimate
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::EstimateCost(const InputSizeType & size,
+                                                                                   const SpacingType &   spacing) const
+{
+  if (this->IsStrided())
+  {
+    // The output is allocated first. Each pass then writes a new image
+    // from the one before, so two intermediates are alive at a time.
+    ParabolicCostEstimate           cost;
+    const std::vector<unsigned int> passAxes = ParabolicStridedAxes(m_Scale, m_OutputStride, m_AxisOrder);
+    InputSizeType                   passSize = size;
+    SizeValueType                   intermediateBytes = 0;
+    for (size_t p = 0; p < passAxes.size(); ++p)
     {
-      // create a vector to buffer lines
-      unsigned long LineLength = region.GetSize()[m_CurrentDimension];
-      // RealType magnitude = 1.0/(2.0 * m_Scale[dd]);
-      RealType image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
+      const unsigned int  d = passAxes[p];
+      const InputSizeType sourceSize = passSize;
+      passSize[d] = ParabolicStridedLength(passSize[d], m_OutputStride[d]);
+      const SizeValueType sourceBytes = p > 0 ? ParabolicImageBytes<OutputPixelType>(sourceSize) : 0;
+      const SizeValueType destinationBytes =
+        p + 1 < passAxes.size() ? ParabolicImageBytes<OutputPixelType>(passSize) : 0;
+      intermediateBytes = std::max(intermediateBytes, sourceBytes + destinationBytes);
+      if (m_Scale[d] > 0)
+      {
+        RadiusType scale;
+        scale.Fill(0);
+        scale[d] = m_Scale[d];
+        cost.Operations += ParabolicPassOperations(
+          sourceSize, scale, spacing, m_UseImageSpacing, m_ParabolicAlgorithm, this->GetInfluenceRange());
+      }
+      else
+      {
+        // only decimates
+        cost.Operations += static_cast<double>(typename TInputImage::RegionType(passSize).GetNumberOfPixels());
+      }
+    }
+    if (!m_OutputPixelContainer)
+    {
+      cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(passSize);
+    }
+    // same choice as GeneratePass
+    const bool singleThreaded = this->GetNumberOfWorkUnits() == 1 ||
+                                typename TInputImage::RegionType(size).GetNumberOfPixels() <= m_SmallImageThreshold;
+    cost.PeakBytes += intermediateBytes +
+                      ParabolicLineScratchBytes<RealType>(size, singleThreaded ? 1 : this->GetNumberOfWorkUnits());
+    return cost;
+  }
 
-      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
-        inputIteratorStage2,
-        outputIterator,
-        progress,
-        LineLength,
-        m_CurrentDimension,
-        this->m_UseImageSpacing,
-        image_scale,
-        this->m_Scale[m_CurrentDimension],
-        m_ParabolicAlgorithm);
+  OutputSizeType outputSize;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    outputSize[d] = size[d] + m_BorderPadLowerBound[d] + m_BorderPadUpperBound[d];
+  }
+  const SizeValueType outputBytes = ParabolicImageBytes<OutputPixelType>(outputSize);
+  // the whole image needs no margin
+  const bool inPlace = this->GetInPlace() && Superclass::CanRunInPlace() &&
+                       !ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound);
+
+  // A masked update always uses the intersection algorithm, keeps no
+  // cache and records where each line is inside the mask. What the
+  // mask skips depends on its contents, so the work is charged as if
+  // every pixel were inside.
+  const bool masked = this->GetMaskImage() != nullptr;
+
+  ParabolicCostEstimate cost;
+  if (!m_OutputPixelContainer && !inPlace)
+  {
+    cost.PeakBytes += outputBytes;
+  }
+  const bool         singleThreaded =
+    this->GetNumberOfWorkUnits() == 1 || outputBytes / sizeof(OutputPixelType) <= m_SmallImageThreshold;
+  const ThreadIdType workUnits = singleThreaded ? 1 : this->GetNumberOfWorkUnits();
+  cost.PeakBytes += ParabolicLineScratchBytes<RealType>(outputSize, workUnits);
+  if (masked)
+  {
+    SizeValueType positions = 0;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      positions += outputSize[d];
     }
+    cost.PeakBytes += positions * sizeof(int) * workUnits;
+  }
+
+  const std::vector<unsigned int> passAxes = ParabolicActiveAxes(m_Scale);
+  if (m_UseIntermediateCache && !masked && passAxes.size() > 1)
+  {
+    cost.PeakBytes += (passAxes.size() - 1) * outputBytes;
+  }
+  cost.Operations = ParabolicPassOperations(outputSize,
+                                            m_Scale,
+                                            spacing,
+                                            m_UseImageSpacing,
+                                            masked ? static_cast<int>(INTERSECTION) : m_ParabolicAlgorithm,
+                                            this->GetInfluenceRange());
+  if (passAxes.empty())
+  {
+    // a copy
+    cost.Operations = static_cast<double>(outputBytes / sizeof(OutputPixelType));
   }
+  return cost;
 }
 
 template <typename TInputImage, bool doDilate, typename TOutputImage>
@@ -293,6 +1135,21 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::PrintSelf(
   {
     os << "Scale in voxels: " << m_Scale << std::endl;
   }
+  os << indent << "AxisOrder: " << m_AxisOrder << std::endl;
+  os << indent << "UseIntermediateCache: " << m_UseIntermediateCache << std::endl;
+  os << indent << "SmallImageThreshold: " << m_SmallImageThreshold << std::endl;
+  os << indent << "ValueRange: " << m_ValueRange << std::endl;
+  os << indent << "OutputStride: " << m_OutputStride << std::endl;
+  os << indent << "BorderPadLowerBound: " << m_BorderPadLowerBound << std::endl;
+  os << indent << "BorderPadUpperBound: " << m_BorderPadUpperBound << std::endl;
+  os << indent << "BorderValue: " << static_cast<typename NumericTraits<PixelType>::PrintType>(m_BorderValue)
+     << std::endl;
+  os << indent << "Prologue: " << (m_LineFunctions.Prologue ? "set" : "none") << std::endl;
+  os << indent << "Epilogue: " << (m_LineFunctions.Epilogue ? "set" : "none") << std::endl;
+  os << indent << "CheckpointFileName: " << m_CheckpointFileName << std::endl;
+  os << indent << "NumberOfResumedPasses: " << m_NumberOfResumedPasses << std::endl;
+  os << indent << "NumberOfCachedPassesUsed: " << m_NumberOfCachedPassesUsed << std::endl;
+  itkPrintSelfObjectMacro(OutputPixelContainer);
 }
 } // namespace itk
 #endif
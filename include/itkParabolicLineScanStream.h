@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicLineScanStream_h
+#define itkParabolicLineScanStream_h
+
+#include <deque>
+#include <vector>
+#include "itkFloatTypes.h"
+#include "itkNumericTraits.h"
+#include "itkVector.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicLineScanStream
+ * \brief Parabolic erosion, dilation, opening and closing of 2D images
+ * that arrive one row at a time.
+ *
+ * A line scan camera delivers a frame row by row, and the result is
+ * wanted with a bounded delay rather than once the frame is complete.
+ * Each row is processed along its length as it arrives (PushRow) and
+ * kept in a window of recent rows. Across rows, a value moved by k
+ * rows is penalised by (k * spacing)^2 / (2 scale), so once that
+ * exceeds the range of the values it can never win: a row is finished
+ * once Radius = floor(sqrt(2 scale range) / spacing) more rows have
+ * arrived, and is then available from PopRow. An opening or closing
+ * chains two such stages, so its latency is the sum of both radii.
+ * Finish() ends the frame, finishing the rows still waiting.
+ *
+ * The range is ValueRange when declared, or the range of an integer
+ * pixel type. Floating point pixels with a non zero scale across rows
+ * need a ValueRange, and values outside it give wrong results. The
+ * results match ParabolicErodeImageFilter, ParabolicDilateImageFilter
+ * and ParabolicOpenCloseImageFilter (without a border) on the whole
+ * frame, up to rounding. Each finished row costs Width * (2 Radius + 1)
+ * steps per stage across rows, on top of the line kernel along it, and
+ * the memory is a window of 2 Radius + 1 rows per stage.
+ *
+ * Instances are independent, but one instance must be driven from one
+ * thread at a time.
+ *
+ * \sa ParabolicEngine ParabolicErodeDilateImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ **/
+template <typename TPixel, typename TOutputPixel = TPixel>
+class ITK_TEMPLATE_EXPORT ParabolicLineScanStream
+{
+public:
+  /** Standard class type alias. */
+  using Self = ParabolicLineScanStream;
+
+  using PixelType = TPixel;
+  using OutputPixelType = TOutputPixel;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+
+  /** Rows are along direction 0, and arrive along direction 1. */
+  static constexpr unsigned int ImageDimension = 2;
+
+  /** a type to represent the "kernel radius" */
+  using RadiusType = FixedArray<ScalarRealType, ImageDimension>;
+  using SpacingType = Vector<SpacePrecisionType, ImageDimension>;
+
+  enum OperationType
+  {
+    ERODE = 0,
+    DILATE = 1,
+    OPEN = 2,
+    CLOSE = 3
+  };
+
+  enum ParabolicAlgorithm
+  {
+    NOCHOICE = 0,     // decices based on scale - experimental
+    CONTACTPOINT = 1, // sometimes faster at low scale
+    INTERSECTION = 2  // default
+  };
+
+  /** The settings of a frame, with the same meaning as the filter
+   * settings of the same name. */
+  struct Parameters
+  {
+    Parameters()
+    {
+      Scale.Fill(1);
+      Spacing.Fill(1);
+    }
+
+    RadiusType     Scale;
+    SpacingType    Spacing;
+    bool           UseImageSpacing{ false };
+    int            ParabolicAlgorithm{ INTERSECTION };
+    int            Operation{ ERODE };
+    ScalarRealType ValueRange{ 0 };
+  };
+
+  /** Begin a frame of rows of width pixels, discarding any rows of the
+   * previous frame. */
+  void
+  Start(SizeValueType width, const Parameters & parameters);
+
+  /** Add the next row of the frame: width pixels. */
+  void
+  PushRow(const PixelType * row);
+
+  /** End the frame. Every row pushed becomes finished. */
+  void
+  Finish();
+
+  /** Copy the oldest finished row, not yet popped, to row (width
+   * pixels). Returns false when no row is finished. */
+  bool
+  PopRow(OutputPixelType * row);
+
+  /** Finished rows waiting to be popped. */
+  SizeValueType
+  GetNumberOfFinishedRows() const
+  {
+    return static_cast<SizeValueType>(m_Finished.size());
+  }
+
+  /** Rows that must follow a row before it is finished. */
+  SizeValueType
+  GetLatency() const;
+
+  SizeValueType
+  GetWidth() const
+  {
+    return m_Width;
+  }
+
+private:
+  using RowType = std::vector<RealType>;
+
+  /** One erosion or dilation: the rows processed along their length
+   * and waiting for the rows that can still change them. */
+  struct Stage
+  {
+    bool          Dilate{ false };
+    int           Algorithm{ INTERSECTION };
+    RealType      Sigma[ImageDimension]{};
+    RealType      Magnitude[ImageDimension]{};
+    SizeValueType Radius{ 0 };
+    // penalty of a value moved k rows, for k up to Radius
+    std::vector<RealType> Penalty;
+    // rows WindowStart onwards, processed along their length
+    std::deque<RowType> Window;
+    SizeValueType       WindowStart{ 0 };
+    SizeValueType       RowsIn{ 0 };
+    SizeValueType       RowsOut{ 0 };
+  };
+
+  /** Pass row through stages s onwards. */
+  void
+  Feed(unsigned int s, RowType & row);
+
+  /** Emit the rows of stage s that are finished, or all of them once
+   * the frame has ended. */
+  void
+  Drain(unsigned int s);
+
+  /** Along the length of a row. */
+  template <bool doDilate>
+  void
+  ProcessAlongRow(const Stage & stage, RowType & row);
+
+  /** Row y of a stage, from the rows of its window. */
+  template <bool doDilate>
+  void
+  ProcessAcrossRows(const Stage & stage, SizeValueType y, RowType & row) const;
+
+  /** Convert to the output type and back, as the filters do between
+   * passes: a static_cast, which truncates integer results toward
+   * zero rather than rounding them. */
+  static void
+  CastToOutput(RowType & row);
+
+  RowType
+  TakeRow();
+
+  SizeValueType                  m_Width{ 0 };
+  bool                           m_Ended{ false };
+  std::vector<Stage>             m_Stages;
+  std::deque<RowType>            m_Finished;
+  std::vector<RowType>           m_Spare;
+  ParabolicLineScratch<RealType> m_Scratch;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicLineScanStream.hxx"
+#endif
+
+#endif
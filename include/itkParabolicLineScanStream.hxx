@@ -0,0 +1,303 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicLineScanStream_hxx
+#define itkParabolicLineScanStream_hxx
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template <typename TPixel, typename TOutputPixel>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::Start(const SizeValueType width, const Parameters & parameters)
+{
+  if (parameters.Operation < ERODE || parameters.Operation > CLOSE)
+  {
+    itkGenericExceptionMacro(<< "ParabolicLineScanStream: unknown Operation " << parameters.Operation);
+  }
+
+  double range = parameters.ValueRange;
+  if (range <= 0)
+  {
+    range = ParabolicPixelTypeRange<PixelType>();
+  }
+
+  m_Width = width;
+  m_Ended = false;
+  m_Finished.clear();
+  m_Scratch.SetLineLength(width);
+
+  // the stages in the order they are applied
+  std::vector<bool> dilate;
+  switch (parameters.Operation)
+  {
+    case DILATE:
+      dilate = { true };
+      break;
+    case OPEN:
+      dilate = { false, true };
+      break;
+    case CLOSE:
+      dilate = { true, false };
+      break;
+    default:
+      dilate = { false };
+      break;
+  }
+
+  m_Stages.assign(dilate.size(), Stage());
+  for (unsigned int s = 0; s < m_Stages.size(); ++s)
+  {
+    Stage & stage = m_Stages[s];
+    stage.Dilate = dilate[s];
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      const RealType iscale = parameters.UseImageSpacing ? parameters.Spacing[d] : 1.0;
+      stage.Sigma[d] = parameters.Scale[d];
+      stage.Magnitude[d] = stage.Sigma[d] > 0 ? (iscale * iscale) / (2.0 * stage.Sigma[d]) : 0;
+    }
+    stage.Algorithm = parameters.ParabolicAlgorithm;
+    if (stage.Algorithm == NOCHOICE)
+    {
+      // same choice as doOneDimension makes
+      stage.Algorithm = (2.0 * stage.Sigma[0]) < 0.2 ? CONTACTPOINT : INTERSECTION;
+    }
+
+    if (stage.Sigma[1] > 0)
+    {
+      if (!(range > 0))
+      {
+        itkGenericExceptionMacro(<< "ParabolicLineScanStream: a ValueRange is needed to bound the rows a row "
+                                    "depends on");
+      }
+      stage.Radius = static_cast<SizeValueType>(std::floor(std::sqrt(range / stage.Magnitude[1])));
+    }
+    stage.Penalty.resize(stage.Radius + 1);
+    for (SizeValueType k = 0; k <= stage.Radius; ++k)
+    {
+      stage.Penalty[k] = stage.Magnitude[1] * static_cast<RealType>(k) * static_cast<RealType>(k);
+    }
+  }
+}
+
+template <typename TPixel, typename TOutputPixel>
+SizeValueType
+ParabolicLineScanStream<TPixel, TOutputPixel>::GetLatency() const
+{
+  SizeValueType latency = 0;
+  for (const Stage & stage : m_Stages)
+  {
+    latency += stage.Radius;
+  }
+  return latency;
+}
+
+template <typename TPixel, typename TOutputPixel>
+typename ParabolicLineScanStream<TPixel, TOutputPixel>::RowType
+ParabolicLineScanStream<TPixel, TOutputPixel>::TakeRow()
+{
+  if (m_Spare.empty())
+  {
+    return RowType(m_Width);
+  }
+  RowType row = std::move(m_Spare.back());
+  m_Spare.pop_back();
+  row.resize(m_Width);
+  return row;
+}
+
+template <typename TPixel, typename TOutputPixel>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::CastToOutput(RowType & row)
+{
+  for (RealType & v : row)
+  {
+    v = static_cast<RealType>(static_cast<OutputPixelType>(v));
+  }
+}
+
+template <typename TPixel, typename TOutputPixel>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::PushRow(const PixelType * row)
+{
+  if (m_Stages.empty() || m_Ended)
+  {
+    itkGenericExceptionMacro(<< "ParabolicLineScanStream: PushRow outside of a frame; call Start first");
+  }
+  RowType line = this->TakeRow();
+  std::copy(row, row + m_Width, line.begin());
+  this->Feed(0, line);
+}
+
+template <typename TPixel, typename TOutputPixel>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::Finish()
+{
+  m_Ended = true;
+  for (unsigned int s = 0; s < m_Stages.size(); ++s)
+  {
+    this->Drain(s);
+  }
+}
+
+template <typename TPixel, typename TOutputPixel>
+bool
+ParabolicLineScanStream<TPixel, TOutputPixel>::PopRow(OutputPixelType * row)
+{
+  if (m_Finished.empty())
+  {
+    return false;
+  }
+  RowType & line = m_Finished.front();
+  std::copy(line.begin(), line.end(), row);
+  m_Spare.push_back(std::move(line));
+  m_Finished.pop_front();
+  return true;
+}
+
+template <typename TPixel, typename TOutputPixel>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::Feed(const unsigned int s, RowType & row)
+{
+  if (s == m_Stages.size())
+  {
+    m_Finished.push_back(std::move(row));
+    return;
+  }
+  Stage & stage = m_Stages[s];
+  if (stage.Dilate)
+  {
+    this->ProcessAlongRow<true>(stage, row);
+  }
+  else
+  {
+    this->ProcessAlongRow<false>(stage, row);
+  }
+  CastToOutput(row);
+  stage.Window.push_back(std::move(row));
+  ++stage.RowsIn;
+  this->Drain(s);
+}
+
+template <typename TPixel, typename TOutputPixel>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::Drain(const unsigned int s)
+{
+  Stage & stage = m_Stages[s];
+  while (stage.RowsOut < stage.RowsIn && (m_Ended || stage.RowsOut + stage.Radius < stage.RowsIn))
+  {
+    RowType row = this->TakeRow();
+    if (stage.Dilate)
+    {
+      this->ProcessAcrossRows<true>(stage, stage.RowsOut, row);
+    }
+    else
+    {
+      this->ProcessAcrossRows<false>(stage, stage.RowsOut, row);
+    }
+    CastToOutput(row);
+    ++stage.RowsOut;
+
+    // rows more than Radius before the next one are no longer needed
+    while (stage.WindowStart + stage.Radius < stage.RowsOut)
+    {
+      m_Spare.push_back(std::move(stage.Window.front()));
+      stage.Window.pop_front();
+      ++stage.WindowStart;
+    }
+    this->Feed(s + 1, row);
+  }
+  if (m_Ended && s + 1 < m_Stages.size())
+  {
+    this->Drain(s + 1);
+  }
+}
+
+template <typename TPixel, typename TOutputPixel>
+template <bool doDilate>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::ProcessAlongRow(const Stage & stage, RowType & row)
+{
+  using LineBufferType = typename ParabolicLineScratch<RealType>::LineBufferType;
+  using IndexBufferType = typename ParabolicLineScratch<RealType>::IndexBufferType;
+
+  if (!(stage.Sigma[0] > 0) || m_Width == 0)
+  {
+    return;
+  }
+  LineBufferType & LineBuf = m_Scratch.LineBuf;
+  std::copy(row.begin(), row.end(), LineBuf.begin());
+
+  bool                   unchanged;
+  const LineBufferType * result;
+  if (stage.Algorithm == CONTACTPOINT)
+  {
+    constexpr int  magnitudeSign = doDilate ? 1 : -1;
+    const RealType magnitudeCP = magnitudeSign * stage.Magnitude[0];
+    result = &ParabolicProcessLine<RealType, doDilate>(
+      m_Scratch,
+      CONTACTPOINT,
+      magnitudeCP,
+      [&]() { DoLineCP<LineBufferType, RealType, doDilate>(LineBuf, m_Scratch.tmpLineBuf, magnitudeCP); },
+      unchanged);
+  }
+  else
+  {
+    const RealType magnitudeInt = stage.Magnitude[0];
+    result = &ParabolicProcessLine<RealType, doDilate>(
+      m_Scratch,
+      INTERSECTION,
+      magnitudeInt,
+      [&]() {
+        DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
+          LineBuf, m_Scratch.Fbuf, m_Scratch.Vbuf, m_Scratch.Zbuf, magnitudeInt);
+      },
+      unchanged);
+  }
+  std::copy(result->begin(), result->end(), row.begin());
+}
+
+template <typename TPixel, typename TOutputPixel>
+template <bool doDilate>
+void
+ParabolicLineScanStream<TPixel, TOutputPixel>::ProcessAcrossRows(const Stage &       stage,
+                                                                  const SizeValueType y,
+                                                                  RowType &           row) const
+{
+  // rows within Radius of y, as far as they exist
+  const SizeValueType first = y > stage.Radius ? y - stage.Radius : 0;
+  const SizeValueType last = std::min(y + stage.Radius, stage.RowsIn - 1);
+
+  std::copy(stage.Window[y - stage.WindowStart].begin(), stage.Window[y - stage.WindowStart].end(), row.begin());
+  for (SizeValueType r = first; r <= last; ++r)
+  {
+    if (r == y)
+    {
+      continue;
+    }
+    const RowType & other = stage.Window[r - stage.WindowStart];
+    const RealType  penalty = stage.Penalty[r > y ? r - y : y - r];
+    for (SizeValueType x = 0; x < m_Width; ++x)
+    {
+      row[x] = doDilate ? std::max(row[x], other[x] - penalty) : std::min(row[x], other[x] + penalty);
+    }
+  }
+}
+} // namespace itk
+#endif
@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicMappedImageContainer_h
+#define itkParabolicMappedImageContainer_h
+
+#include <string>
+#include "itkImportImageContainer.h"
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace itk
+{
+/**
+ * \class ParabolicMappedImageContainer
+ * \brief A pixel container backed by a memory mapped file.
+ *
+ * MapFile() creates the file, or extends it, to hold the given number
+ * of pixels after an optional header and maps it into memory. Used as
+ * the output pixel container of a parabolic filter (see
+ * ParabolicErodeDilateImageFilter::SetOutputPixelContainer), the
+ * result is written straight into the file: the operating system pages
+ * the data in and out, so results close to the size of physical memory
+ * can be produced, and no separate writer pass is needed. The header
+ * of a format with the data attached (NRRD, for example) can be
+ * written before mapping and skipped with headerBytes; for formats
+ * with a detached header (MetaImage with a raw ElementDataFile) the
+ * file is the raw data.
+ *
+ * The pixels are stored in the byte order of the machine. The file is
+ * flushed and unmapped when the container is destroyed, or earlier
+ * with Flush() and Unmap(). Operations that reallocate the container,
+ * such as Reserve() beyond the mapped size or Squeeze(), move the data
+ * off the file.
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename TElementIdentifier, typename TElement>
+class ITK_TEMPLATE_EXPORT ParabolicMappedImageContainer : public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicMappedImageContainer);
+
+  /** Standard class type alias. */
+  using Self = ParabolicMappedImageContainer;
+  using Superclass = ImportImageContainer<TElementIdentifier, TElement>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using ElementIdentifier = TElementIdentifier;
+  using Element = TElement;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicMappedImageContainer, ImportImageContainer);
+
+  /** Map numberOfElements pixels of fileName, starting headerBytes
+   * into the file, replacing any existing mapping. The file is
+   * created if necessary and extended if it is too small, but never
+   * truncated. */
+  void
+  MapFile(const std::string & fileName, ElementIdentifier numberOfElements, std::size_t headerBytes = 0)
+  {
+    this->Unmap();
+    const std::size_t length = headerBytes + static_cast<std::size_t>(numberOfElements) * sizeof(Element);
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName.c_str(),
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      itkExceptionMacro(<< "Cannot open " << fileName);
+    }
+    const auto mapping = CreateFileMappingA(file,
+                                            nullptr,
+                                            PAGE_READWRITE,
+                                            static_cast<DWORD>(static_cast<unsigned long long>(length) >> 32),
+                                            static_cast<DWORD>(length & 0xffffffffULL),
+                                            nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+      itkExceptionMacro(<< "Cannot map " << fileName);
+    }
+    void * base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length);
+    CloseHandle(mapping);
+    if (base == nullptr)
+    {
+      itkExceptionMacro(<< "Cannot map " << fileName);
+    }
+#else
+    const int file = open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+    {
+      itkExceptionMacro(<< "Cannot open " << fileName);
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 ||
+        (static_cast<std::size_t>(status.st_size) < length && ftruncate(file, static_cast<off_t>(length)) != 0))
+    {
+      close(file);
+      itkExceptionMacro(<< "Cannot resize " << fileName << " to " << length << " bytes");
+    }
+    void * base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    if (base == MAP_FAILED)
+    {
+      itkExceptionMacro(<< "Cannot map " << fileName);
+    }
+#endif
+    m_Base = base;
+    m_Length = length;
+    m_FileName = fileName;
+    this->SetImportPointer(reinterpret_cast<Element *>(static_cast<char *>(base) + headerBytes), numberOfElements);
+  }
+
+  /** Write modified pages back to the file. */
+  void
+  Flush()
+  {
+    if (m_Base)
+    {
+#if defined(_WIN32)
+      FlushViewOfFile(m_Base, m_Length);
+#else
+      msync(m_Base, m_Length, MS_SYNC);
+#endif
+    }
+  }
+
+  /** Flush and release the mapping. The container is left empty. */
+  void
+  Unmap()
+  {
+    if (m_Base)
+    {
+      this->Flush();
+      this->SetImportPointer(nullptr, 0);
+#if defined(_WIN32)
+      UnmapViewOfFile(m_Base);
+#else
+      munmap(m_Base, m_Length);
+#endif
+      m_Base = nullptr;
+      m_Length = 0;
+    }
+  }
+
+  /** The file currently, or most recently, mapped. */
+  const std::string &
+  GetFileName() const
+  {
+    return m_FileName;
+  }
+
+protected:
+  ParabolicMappedImageContainer() = default;
+  ~ParabolicMappedImageContainer() override { this->Unmap(); }
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override
+  {
+    Superclass::PrintSelf(os, indent);
+    os << indent << "FileName: " << m_FileName << std::endl;
+    os << indent << "Mapped bytes: " << m_Length << std::endl;
+  }
+
+private:
+  void *      m_Base{ nullptr };
+  std::size_t m_Length{ 0 };
+  std::string m_FileName;
+};
+} // end namespace itk
+
+#endif
@@ -18,19 +18,33 @@
 #ifndef itkParabolicMorphUtils_h
 #define itkParabolicMorphUtils_h
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
 #include <itkArray.h>
 
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkProgressReporter.h"
+#include "itkProcessObject.h"
 
 namespace itk
 {
 // contact point algorithm
-template <typename LineBufferType, typename RealType, typename TInputPixel, bool doDilate>
+// The search starts from the extreme of RealType, the type the line is
+// held in, rather than of the input pixel: a prologue can move values
+// outside the range of the input.
+template <typename LineBufferType, typename RealType, bool doDilate>
 void
 DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType magnitude)
 {
   static constexpr RealType extreme =
-    doDilate ? NumericTraits<TInputPixel>::NonpositiveMin() : NumericTraits<TInputPixel>::max();
+    doDilate ? NumericTraits<RealType>::NonpositiveMin() : NumericTraits<RealType>::max();
 
   // contact point algorithm
   long koffset = 0, newcontact = 0; // how far away the search starts.
@@ -78,13 +92,17 @@ DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType m
 // This algorithm has been described a couple of times. First by van
 // den Boomgaard and more recently by Felzenszwalb and Huttenlocher,
 // in the context of generalized distance transform
+// With a stride above 1 the envelope is still built from every
+// position, but only positions 0, stride, 2 stride... are evaluated,
+// and their results are packed at the start of LineBuf.
 template <typename LineBufferType, typename IndexBufferType, typename EnvBufferType, typename RealType, bool doDilate>
 void
 DoLineIntAlg(LineBufferType &  LineBuf,
              EnvBufferType &   F,
              IndexBufferType & v,
              EnvBufferType &   z,
-             const RealType    magnitude)
+             const RealType    magnitude,
+             const size_t      stride = 1)
 {
   int k; /* Index of rightmost parabola in lower envelope */
   /* Locations of parabolas in lower envelope */
@@ -151,7 +169,7 @@ DoLineIntAlg(LineBufferType &  LineBuf,
   if (doDilate)
   {
     k = 0;
-    for (size_t q = 0; q < N; q++)
+    for (size_t j = 0, q = 0; q < N; j++, q += stride)
     {
       while (z[k + 1] < static_cast<typename IndexBufferType::ValueType>(q))
       {
@@ -159,14 +177,14 @@ DoLineIntAlg(LineBufferType &  LineBuf,
       }
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) < N);
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) >= 0);
-      LineBuf[q] = static_cast<RealType>(
+      LineBuf[j] = static_cast<RealType>(
         (F[v[k]] - (static_cast<RealType>(q) * (static_cast<RealType>(q) - 2 * v[k]))) * magnitude);
     }
   }
   else
   {
     k = 0;
-    for (size_t q = 0; q < N; q++)
+    for (size_t j = 0, q = 0; q < N; j++, q += stride)
     {
       while (z[k + 1] < static_cast<typename IndexBufferType::ValueType>(q))
       {
@@ -174,27 +192,820 @@ DoLineIntAlg(LineBufferType &  LineBuf,
       }
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) < N);
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) >= 0);
-      LineBuf[q] = ((static_cast<RealType>(q) * (static_cast<RealType>(q) - 2 * v[k]) + F[v[k]]) * magnitude);
+      LineBuf[j] = ((static_cast<RealType>(q) * (static_cast<RealType>(q) - 2 * v[k]) + F[v[k]]) * magnitude);
     }
   }
 }
 
+// The intersection algorithm over the first N samples of LineBuf,
+// which sit at positions P (increasing) along the line, evaluated at
+// the same positions. The gaps between the samples take no part in
+// the envelope. Used for the samples of a line inside a mask.
+template <typename LineBufferType, typename IndexBufferType, typename RealType, bool doDilate>
+void
+DoLineIntAlgAt(LineBufferType &        LineBuf,
+               const IndexBufferType & P,
+               const size_t            N,
+               LineBufferType &        F,
+               IndexBufferType &       v,
+               LineBufferType &        z,
+               const RealType          magnitude)
+{
+  constexpr RealType sign = doDilate ? -1 : 1;
+  const auto         position = [&P](const size_t i) { return static_cast<RealType>(P[i]); };
+
+  int      k = 0;
+  RealType s;
+  v[0] = 0;
+  z[0] = NumericTraits<int>::NonpositiveMin();
+  z[1] = NumericTraits<int>::max();
+  F[0] = LineBuf[0] / magnitude + sign * position(0) * position(0);
+  for (size_t q = 1; q < N; q++)
+  {
+    const RealType p = position(q);
+    F[q] = LineBuf[q] / magnitude + sign * p * p;
+    k++;
+    do
+    {
+      k--;
+      s = sign * (F[q] - F[v[k]]) / (2.0 * (p - position(v[k])));
+    } while (s <= z[k]);
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = NumericTraits<int>::max();
+  }
+
+  k = 0;
+  for (size_t q = 0; q < N; q++)
+  {
+    const RealType p = position(q);
+    while (z[k + 1] < p)
+    {
+      k++;
+    }
+    LineBuf[q] = (sign * p * (p - 2 * position(v[k])) + F[v[k]]) * magnitude;
+  }
+}
+
+// Give an internal filter of a composite the composite's
+// MultiThreader and number of work units. Every stage of the
+// mini-pipeline then draws on the same thread budget, which the caller
+// caps with SetNumberOfWorkUnits on the composite alone. The stages
+// run one after another, so sharing the threader between them is safe.
+// A threader given to the composite with SetMultiThreader must not be
+// shared with filters that run at the same time (see
+// ParabolicUpdateAsync): the single method state it holds is not
+// thread safe.
+inline void
+ParabolicShareThreadBudget(ProcessObject * composite, ProcessObject * internal)
+{
+  if (internal->GetMultiThreader() != composite->GetMultiThreader())
+  {
+    internal->SetMultiThreader(composite->GetMultiThreader());
+  }
+  if (internal->GetNumberOfWorkUnits() != composite->GetNumberOfWorkUnits())
+  {
+    internal->SetNumberOfWorkUnits(composite->GetNumberOfWorkUnits());
+  }
+}
+
+// The binary filters can keep their intermediate images as 16-bit
+// fixed point rather than float (CompactIntermediates). The mask is
+// scaled so that 1 is stored as ParabolicFixedPointOne, and the
+// parabolic scale is divided by the same factor, which multiplies the
+// result of every pass by it. The line kernels still work in floating
+// point, but each pass truncates its result as it stores it, so a
+// final value is low by less than one per pass, at most
+// ImageDimension. The thresholds allow for that, and the only pixels
+// that can differ from the float result are those whose squared
+// distance to the edge of the structuring element is within a
+// fraction ImageDimension / ParabolicFixedPointOne of the squared
+// radius. In pixel units squared distances are integers, so the
+// results are identical up to a radius of about
+// sqrt(ParabolicFixedPointOne / ImageDimension), 90 pixels in 2D and
+// 73 in 3D. A power of two leaves headroom below the largest short.
+constexpr int ParabolicFixedPointOne = 16384;
+
+// The directions that need a pass, in the order they are processed.
+// Directions with a zero scale leave the image unchanged, so they are
+// skipped entirely rather than costing a pass. Direction 0 is
+// contiguous in memory, so going in increasing order means the pass
+// that reads the input (possibly a different pixel type) is the one
+// with the cheapest access pattern.
+template <typename TRadius>
+std::vector<unsigned int>
+ParabolicActiveAxes(const TRadius & scale)
+{
+  std::vector<unsigned int> axes;
+  for (unsigned int d = 0; d < TRadius::Length; ++d)
+  {
+    if (scale[d] > 0)
+    {
+      axes.push_back(d);
+    }
+  }
+  return axes;
+}
+
+// Make a caller supplied pixel container, a memory mapped file for
+// example, the buffer of an output over its requested region. Returns
+// false, leaving the output alone, if there is no container.
+template <typename TImage>
+bool
+ParabolicUseOutputContainer(TImage * image, typename TImage::PixelContainer * container)
+{
+  if (container == nullptr)
+  {
+    return false;
+  }
+  const SizeValueType numberOfPixels = image->GetRequestedRegion().GetNumberOfPixels();
+  if (container->Capacity() < numberOfPixels)
+  {
+    itkGenericExceptionMacro(<< "Output pixel container holds " << container->Capacity() << " pixels, but "
+                             << numberOfPixels << " are needed");
+  }
+  image->SetBufferedRegion(image->GetRequestedRegion());
+  image->SetPixelContainer(container);
+  return true;
+}
+
+// Grow a requested region to the whole of the largest possible region
+// along the directions that have a pass. Lines along those directions
+// must be processed whole, but lines are independent of each other, so
+// a pipeline can still stream across the remaining directions.
+template <typename TRegion, typename TRadius>
+TRegion
+ParabolicEnlargeAlongActiveAxes(const TRegion & requested, const TRegion & largest, const TRadius & scale)
+{
+  TRegion region = requested;
+  for (unsigned int d = 0; d < TRadius::Length; ++d)
+  {
+    if (scale[d] > 0)
+    {
+      region.SetIndex(d, largest.GetIndex(d));
+      region.SetSize(d, largest.GetSize(d));
+    }
+  }
+  return region;
+}
+
+// The range of values a pixel type can hold, or 0 when it is
+// unbounded for practical purposes (floating point types). Passes
+// never widen the range of their input, so this also bounds every
+// intermediate result.
+template <typename TPixel>
+double
+ParabolicPixelTypeRange()
+{
+  if (NumericTraits<TPixel>::is_integer)
+  {
+    return static_cast<double>(NumericTraits<TPixel>::max()) -
+           static_cast<double>(NumericTraits<TPixel>::NonpositiveMin());
+  }
+  return 0;
+}
+
+// Grow a requested region by the distance over which a pass can move
+// a value. Along a direction with scale sigma, a neighbour k pixels
+// away is penalised by (k * spacing)^2 / (2 sigma), so once that
+// exceeds the range of the data it can never win, giving a radius of
+// ceil(sqrt(2 sigma range) / spacing) pixels. Stages is the number of
+// erode/dilate stages applied in sequence, each of which adds a
+// radius. A range of 0 means unknown, in which case whole lines are
+// requested as above.
+template <typename TRegion, typename TRadius, typename TSpacing>
+TRegion
+ParabolicEnlargeByInfluence(const TRegion &  requested,
+                            const TRegion &  largest,
+                            const TRadius &  scale,
+                            const TSpacing & spacing,
+                            const bool       useImageSpacing,
+                            const double     range,
+                            const unsigned   stages = 1)
+{
+  if (range <= 0)
+  {
+    return ParabolicEnlargeAlongActiveAxes(requested, largest, scale);
+  }
+  TRegion region = requested;
+  for (unsigned int d = 0; d < TRadius::Length; ++d)
+  {
+    if (scale[d] > 0)
+    {
+      const double iscale = useImageSpacing ? static_cast<double>(spacing[d]) : 1.0;
+      const double radius = stages * std::ceil(std::sqrt(2.0 * scale[d] * range) / iscale);
+      if (radius >= static_cast<double>(largest.GetSize(d)))
+      {
+        region.SetIndex(d, largest.GetIndex(d));
+        region.SetSize(d, largest.GetSize(d));
+      }
+      else
+      {
+        const auto r = static_cast<typename TRegion::IndexValueType>(radius);
+        region.SetIndex(d, region.GetIndex(d) - r);
+        region.SetSize(d, region.GetSize(d) + 2 * r);
+      }
+    }
+  }
+  region.Crop(largest);
+  return region;
+}
+
+// As above, but visiting the directions in a caller supplied order,
+// which must be a permutation of 0..Length-1.
+template <typename TRadius, typename TAxisOrder>
+std::vector<unsigned int>
+ParabolicActiveAxes(const TRadius & scale, const TAxisOrder & order)
+{
+  std::vector<unsigned int> axes;
+  for (unsigned int p = 0; p < TRadius::Length; ++p)
+  {
+    if (scale[order[p]] > 0)
+    {
+      axes.push_back(order[p]);
+    }
+  }
+  return axes;
+}
+
+// The directions that need a pass when the output keeps every
+// stride[d]-th sample along d. Strided directions with a zero scale
+// only decimate, which is cheap and shortens the lines of every later
+// pass, so they come first, then the directions with a non zero scale
+// in the given order.
+template <typename TRadius, typename TStride, typename TAxisOrder>
+std::vector<unsigned int>
+ParabolicStridedAxes(const TRadius & scale, const TStride & stride, const TAxisOrder & order)
+{
+  std::vector<unsigned int> axes;
+  for (unsigned int p = 0; p < TRadius::Length; ++p)
+  {
+    if (!(scale[order[p]] > 0) && stride[order[p]] > 1)
+    {
+      axes.push_back(order[p]);
+    }
+  }
+  const std::vector<unsigned int> active = ParabolicActiveAxes(scale, order);
+  axes.insert(axes.end(), active.begin(), active.end());
+  return axes;
+}
+
+// Number of samples left of length samples by keeping every stride-th,
+// starting with the first
+inline SizeValueType
+ParabolicStridedLength(const SizeValueType length, const unsigned int stride)
+{
+  return (length + stride - 1) / stride;
+}
+
+/**
+ * \class ParabolicLineScratch
+ * \brief Line buffers used by doOneDimension.
+ *
+ * Holding on to one of these between calls avoids reallocating the
+ * line buffers for every image and direction, which matters when many
+ * small images are processed. The buffers are only resized when the
+ * line length changes.
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename RealType>
+class ParabolicLineScratch
+{
+public:
+  // message from M.Starring suggested performance gain using Array
+  // instead of std::vector.
+  using LineBufferType = typename itk::Array<RealType>;
+  using IndexBufferType = typename itk::Array<int>;
+
+  void
+  SetLineLength(const SizeValueType LineLength)
+  {
+    if (LineBuf.size() != LineLength)
+    {
+      LineBuf.SetSize(LineLength);
+      tmpLineBuf.SetSize(LineLength);
+      Fbuf.SetSize(LineLength);
+      Vbuf.SetSize(LineLength);
+      Zbuf.SetSize(LineLength + 1);
+    }
+  }
+
+  // the line being processed, used by both algorithms
+  LineBufferType LineBuf;
+  // contact point algorithm
+  LineBufferType tmpLineBuf;
+  // intersection algorithm
+  LineBufferType  Fbuf;
+  IndexBufferType Vbuf;
+  LineBufferType  Zbuf;
+  // positions of the samples of a masked line, sized when first used
+  IndexBufferType Pbuf;
+
+  // the result for the last line that was all one value, and what it
+  // was computed with (see ParabolicProcessLine)
+  LineBufferType UniformLineBuf;
+  RealType       UniformValue{};
+  RealType       UniformMagnitude{};
+  int            UniformAlgorithm{ -1 };
+  unsigned int   UniformStride{ 1 };
+  bool           UniformDilate{ false };
+  bool           UniformUnchanged{ false };
+};
+
+/**
+ * \class ParabolicLineScratchSet
+ * \brief Line buffers for every work unit and direction of a filter.
+ *
+ * Filters keep one of these between updates. Each work unit has its
+ * own buffers for each direction, so images whose lines have different
+ * lengths in each direction do not cause a reallocation every pass.
+ * Once sized for a geometry, repeated updates on images of that
+ * geometry (the frames of a time series, for example) do not allocate
+ * line buffers at all.
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename RealType, unsigned int VDimension>
+class ParabolicLineScratchSet
+{
+public:
+  using ScratchType = ParabolicLineScratch<RealType>;
+
+  /** Make sure there are buffers for work units 0..numberOfWorkUnits-1 */
+  void
+  SetNumberOfWorkUnits(const ThreadIdType numberOfWorkUnits)
+  {
+    if (m_Scratch.size() < numberOfWorkUnits * VDimension)
+    {
+      m_Scratch.resize(numberOfWorkUnits * VDimension);
+    }
+  }
+
+  ThreadIdType
+  GetNumberOfWorkUnits() const
+  {
+    return static_cast<ThreadIdType>(m_Scratch.size() / VDimension);
+  }
+
+  /** Size the buffers of every work unit for lines of a region, so
+   * that the work units don't allocate while running. */
+  template <typename TSize>
+  void
+  SetLineLengths(const TSize & size)
+  {
+    for (size_t i = 0; i < m_Scratch.size(); ++i)
+    {
+      m_Scratch[i].SetLineLength(size[i % VDimension]);
+    }
+  }
+
+  ScratchType &
+  Get(const ThreadIdType workUnit, const unsigned int direction)
+  {
+    return m_Scratch[workUnit * VDimension + direction];
+  }
+
+  void
+  Release()
+  {
+    m_Scratch.clear();
+  }
+
+private:
+  std::vector<ScratchType> m_Scratch;
+};
+
+/**
+ * \class ParabolicCostEstimate
+ * \brief Predicted memory and work for one update of a filter.
+ *
+ * PeakBytes counts the image and line buffers a filter allocates,
+ * including those of its internal filters, but not its input.
+ * Operations counts line kernel steps. It grows with the work the
+ * filter does, so it can be used to compare configurations, but it
+ * is not a time. Estimates that depend on the data (the border of
+ * the SafeBorder filters, the search of the contact point algorithm)
+ * assume the worst case for the value range.
+ *
+ * \ingroup ParabolicMorphology
+ */
+struct ParabolicCostEstimate
+{
+  SizeValueType PeakBytes{ 0 };
+  double        Operations{ 0 };
+
+  ParabolicCostEstimate &
+  operator+=(const ParabolicCostEstimate & other)
+  {
+    PeakBytes += other.PeakBytes;
+    Operations += other.Operations;
+    return *this;
+  }
+};
+
+// Bytes of an image buffer of the given size
+template <typename TPixel, typename TSize>
+SizeValueType
+ParabolicImageBytes(const TSize & size)
+{
+  SizeValueType pixels = 1;
+  for (unsigned int d = 0; d < TSize::Dimension; ++d)
+  {
+    pixels *= size[d];
+  }
+  return pixels * sizeof(TPixel);
+}
+
+// Bytes of a ParabolicLineScratchSet sized for lines of an image of
+// the given size
+template <typename RealType, typename TSize>
+SizeValueType
+ParabolicLineScratchBytes(const TSize & size, const ThreadIdType workUnits)
+{
+  SizeValueType bytes = 0;
+  for (unsigned int d = 0; d < TSize::Dimension; ++d)
+  {
+    // LineBuf, tmpLineBuf, Fbuf, Zbuf (one longer) and UniformLineBuf,
+    // and Vbuf
+    bytes += (5 * size[d] + 1) * sizeof(RealType) + size[d] * sizeof(int);
+  }
+  return bytes * workUnits;
+}
+
+// Line kernel steps for one pass along each direction with a non zero
+// scale. The intersection algorithm does a fixed amount of work per
+// pixel. The contact point algorithm searches, for each pixel, up to
+// the distance a value can move, ceil(sqrt(2 sigma range) / spacing),
+// or the whole line when the range is unknown (0).
+template <typename TSize, typename TRadius, typename TSpacing>
+double
+ParabolicPassOperations(const TSize &    size,
+                        const TRadius &  scale,
+                        const TSpacing & spacing,
+                        const bool       useImageSpacing,
+                        const int        algorithm,
+                        const double     range)
+{
+  double pixels = 1;
+  for (unsigned int d = 0; d < TSize::Dimension; ++d)
+  {
+    pixels *= static_cast<double>(size[d]);
+  }
+  double operations = 0;
+  for (const unsigned int d : ParabolicActiveAxes(scale))
+  {
+    // same choice as doOneDimension makes
+    const bool contactPoint = algorithm == 1 || (algorithm == 0 && 2.0 * scale[d] < 0.2);
+    double     search = 0;
+    if (contactPoint)
+    {
+      const double iscale = useImageSpacing ? static_cast<double>(spacing[d]) : 1.0;
+      search = static_cast<double>(size[d]);
+      if (range > 0)
+      {
+        search = std::min(search, std::ceil(std::sqrt(2.0 * scale[d] * range) / iscale));
+      }
+    }
+    // both algorithms make a forward and a backward sweep
+    operations += 2 * pixels * (1 + search);
+  }
+  return operations;
+}
+
+// Largest difference, for one erosion or dilation along one
+// direction, between the exact result and one computed on blocks of
+// factor samples: the extreme of each block, processed at the block
+// spacing and copied back to every sample of the block. sigma is the
+// scale in pixels and range bounds the values. Standing in for a
+// sample, the centre of its block is at most factor - 1 away along
+// the direction from where the parabola meets the data, which changes
+// the parabola by at most ((d + factor - 1)^2 - d^2) / (2 sigma) at a
+// distance d. A contact point is never farther than
+// sqrt(2 sigma range), nor than the line is long. Without a pass
+// (zero sigma) the block extremes can be anything within range.
+inline double
+ParabolicShrinkError(const unsigned int factor, const double sigma, const double range, const SizeValueType length)
+{
+  if (factor <= 1)
+  {
+    return 0;
+  }
+  if (!(sigma > 0))
+  {
+    return range;
+  }
+  const double slack = factor - 1.0;
+  const double reach = std::min(std::sqrt(2.0 * sigma * range) + slack, static_cast<double>(length));
+  return std::min(range, slack * (2.0 * reach + slack) / (2.0 * sigma));
+}
+
+/**
+ * \class ParabolicLineBorder
+ * \brief A constant extension of the lines processed by doOneDimension.
+ *
+ * When the input lines are shorter than the line length, each is read
+ * into the line buffer starting at Lower, and the rest of the buffer is
+ * set to Value. The output lines receive the whole extended line. This
+ * gives the result of padding the input with a constant without
+ * building the padded image.
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename RealType>
+struct ParabolicLineBorder
+{
+  long     Lower{ 0 };
+  RealType Value{ 0 };
+};
+
+// A function applied in place to count values of a line buffer
+template <typename RealType>
+using ParabolicLineFunction = std::function<void(RealType *, SizeValueType)>;
+
+// A ParabolicLineFunction that applies f to each value. The loop is
+// compiled with f inlined, so the only indirect call is once per line.
+template <typename RealType, typename TFunction>
+ParabolicLineFunction<RealType>
+ParabolicPointwise(TFunction f)
+{
+  return [f](RealType * line, const SizeValueType count) {
+    for (SizeValueType i = 0; i < count; ++i)
+    {
+      line[i] = f(line[i]);
+    }
+  };
+}
+
+/**
+ * \class ParabolicLineFunctions
+ * \brief Pointwise work fused into the lines processed by doOneDimension.
+ *
+ * The Prologue is applied to each input line as it is read into the
+ * line buffer, before the kernel, and the Epilogue to each result as
+ * it is written out. Either may be empty. This replaces a full image
+ * pass before or after the filter with work on a line that is already
+ * in cache.
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename RealType>
+struct ParabolicLineFunctions
+{
+  ParabolicLineFunction<RealType> Prologue;
+  ParabolicLineFunction<RealType> Epilogue;
+
+  bool
+  Empty() const
+  {
+    return !Prologue && !Epilogue;
+  }
+
+  // value through the prologue, or the epilogue
+  RealType
+  ApplyPrologue(RealType value) const
+  {
+    if (Prologue)
+    {
+      Prologue(&value, 1);
+    }
+    return value;
+  }
+  RealType
+  ApplyEpilogue(RealType value) const
+  {
+    if (Epilogue)
+    {
+      Epilogue(&value, 1);
+    }
+    return value;
+  }
+};
+
+// Write a processed line to the output iterator's current line,
+// through the epilogue if there is one. The epilogue works on a copy
+// in scratch.tmpLineBuf, as the result may be the cached line for
+// uniform lines.
+template <typename TOutIter, typename RealType>
+void
+ParabolicWriteLine(TOutIter &                                                    outputIterator,
+                   const typename ParabolicLineScratch<RealType>::LineBufferType & result,
+                   ParabolicLineScratch<RealType> &                              scratch,
+                   const ParabolicLineFunctions<RealType> &                      functions)
+{
+  using OutputPixelType = typename TOutIter::PixelType;
+  const RealType * line = result.data_block();
+  if (functions.Epilogue)
+  {
+    std::copy(result.begin(), result.end(), scratch.tmpLineBuf.begin());
+    functions.Epilogue(scratch.tmpLineBuf.data_block(), result.size());
+    line = scratch.tmpLineBuf.data_block();
+  }
+  for (SizeValueType j = 0; !outputIterator.IsAtEndOfLine(); ++j, ++outputIterator)
+  {
+    outputIterator.Set(static_cast<OutputPixelType>(line[j]));
+  }
+}
+
+// true if any side of any direction has a border
+template <typename TSize>
+bool
+ParabolicHasBorder(const TSize & lower, const TSize & upper)
+{
+  for (unsigned int d = 0; d < TSize::Dimension; ++d)
+  {
+    if (lower[d] > 0 || upper[d] > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// FNV-1a hash of which pixels of a region of a mask are set, to tell
+// masks apart across runs
+template <typename TMask, typename TRegion>
+std::uint64_t
+ParabolicMaskDigest(const TMask * mask, const TRegion & region)
+{
+  std::uint64_t digest = 14695981039346656037ULL;
+  for (ImageRegionConstIterator<TMask> it(mask, region); !it.IsAtEnd(); ++it)
+  {
+    digest = (digest ^ (it.Get() ? 1U : 0U)) * 1099511628211ULL;
+  }
+  return digest;
+}
+
+// region grown by lower pixels below and upper pixels above along
+// every direction
+template <typename TRegion, typename TSize>
+TRegion
+ParabolicPadRegion(TRegion region, const TSize & lower, const TSize & upper)
+{
+  for (unsigned int d = 0; d < TRegion::ImageDimension; ++d)
+  {
+    region.SetIndex(d, region.GetIndex(d) - static_cast<IndexValueType>(lower[d]));
+    region.SetSize(d, region.GetSize(d) + lower[d] + upper[d]);
+  }
+  return region;
+}
+
+// Call fill(slab) for disjoint slabs covering the part of region
+// outside inner
+template <typename TRegion, typename TFill>
+void
+ParabolicForEachOutside(TRegion region, const TRegion & inner, TFill fill)
+{
+  for (unsigned int d = 0; d < TRegion::ImageDimension; ++d)
+  {
+    const IndexValueType regionEnd = region.GetIndex(d) + static_cast<IndexValueType>(region.GetSize(d));
+    const IndexValueType innerEnd = inner.GetIndex(d) + static_cast<IndexValueType>(inner.GetSize(d));
+    TRegion              slab = region;
+    // below inner
+    if (inner.GetIndex(d) > region.GetIndex(d))
+    {
+      slab.SetSize(d, static_cast<SizeValueType>(inner.GetIndex(d) - region.GetIndex(d)));
+      fill(slab);
+    }
+    // above inner
+    if (innerEnd < regionEnd)
+    {
+      slab.SetIndex(d, innerEnd);
+      slab.SetSize(d, static_cast<SizeValueType>(regionEnd - innerEnd));
+      fill(slab);
+    }
+    // the rest lies within inner along d
+    region.SetIndex(d, inner.GetIndex(d));
+    region.SetSize(d, inner.GetSize(d));
+  }
+}
+
+// The minimum and maximum of every slice of region normal to each
+// direction, gathered in one pass along the lines of direction 0.
+// minima[d][i] is the minimum of the pixels at index
+// region.GetIndex(d) + i along direction d. Any one direction's
+// profile also gives the extremes of the whole region.
+template <typename TImage>
+void
+ParabolicSliceExtrema(const TImage *                                                                    image,
+                      const typename TImage::RegionType &                                               region,
+                      std::array<std::vector<typename TImage::PixelType>, TImage::ImageDimension> & minima,
+                      std::array<std::vector<typename TImage::PixelType>, TImage::ImageDimension> & maxima)
+{
+  using PixelType = typename TImage::PixelType;
+  constexpr unsigned int ImageDimension = TImage::ImageDimension;
+
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    minima[d].assign(region.GetSize(d), NumericTraits<PixelType>::max());
+    maxima[d].assign(region.GetSize(d), NumericTraits<PixelType>::NonpositiveMin());
+  }
+
+  ImageLinearConstIteratorWithIndex<TImage> it(image, region);
+  it.SetDirection(0);
+  it.GoToBegin();
+  while (!it.IsAtEnd())
+  {
+    const typename TImage::IndexType lineStart = it.GetIndex();
+    PixelType                        lineMin = NumericTraits<PixelType>::max();
+    PixelType                        lineMax = NumericTraits<PixelType>::NonpositiveMin();
+    for (SizeValueType i = 0; !it.IsAtEndOfLine(); ++i, ++it)
+    {
+      const PixelType v = it.Get();
+      lineMin = std::min(lineMin, v);
+      lineMax = std::max(lineMax, v);
+      minima[0][i] = std::min(minima[0][i], v);
+      maxima[0][i] = std::max(maxima[0][i], v);
+    }
+    // the line is a single pixel of every other profile
+    for (unsigned int d = 1; d < ImageDimension; ++d)
+    {
+      const SizeValueType k = static_cast<SizeValueType>(lineStart[d] - region.GetIndex(d));
+      minima[d][k] = std::min(minima[d][k], lineMin);
+      maxima[d][k] = std::max(maxima[d][k], lineMax);
+    }
+    it.NextLine();
+  }
+}
+
+// Apply a line kernel to scratch.LineBuf. Lines that are all one
+// value, such as the empty space of a mask, have the same result
+// wherever they are, so the result for the last such line is kept in
+// scratch and reused while the value and the kernel stay the same.
+// kernel() processes scratch.LineBuf in place, packing the results
+// at the given stride at the start of the buffer. Returns the buffer
+// holding the result, and sets unchanged when the result is the line
+// itself.
+template <typename RealType, bool doDilate, typename TKernel>
+const typename ParabolicLineScratch<RealType>::LineBufferType &
+ParabolicProcessLine(ParabolicLineScratch<RealType> & scratch,
+                     const int                        algorithm,
+                     const RealType                   magnitude,
+                     TKernel                          kernel,
+                     bool &                           unchanged,
+                     const unsigned int               stride = 1)
+{
+  auto & LineBuf = scratch.LineBuf;
+  unchanged = false;
+  if (LineBuf.size() == 0)
+  {
+    return LineBuf;
+  }
+  const RealType value = LineBuf[0];
+  const auto     isValue = [value](const RealType v) { return v == value; };
+  if (!std::all_of(LineBuf.begin(), LineBuf.end(), isValue))
+  {
+    kernel();
+    return LineBuf;
+  }
+  if (scratch.UniformLineBuf.size() != LineBuf.size() || scratch.UniformValue != value ||
+      scratch.UniformMagnitude != magnitude || scratch.UniformAlgorithm != algorithm ||
+      scratch.UniformStride != stride || scratch.UniformDilate != doDilate)
+  {
+    kernel();
+    scratch.UniformLineBuf = LineBuf;
+    scratch.UniformValue = value;
+    scratch.UniformMagnitude = magnitude;
+    scratch.UniformAlgorithm = algorithm;
+    scratch.UniformStride = stride;
+    scratch.UniformDilate = doDilate;
+    scratch.UniformUnchanged = std::all_of(LineBuf.begin(), LineBuf.end(), isValue);
+  }
+  unchanged = scratch.UniformUnchanged;
+  return scratch.UniformLineBuf;
+}
+
+// Stands in for a ProgressReporter when lines are processed outside
+// of a filter
+struct ParabolicNullProgress
+{
+  void
+  CompletedPixel()
+  {}
+};
+
 template <typename TInIter,
           typename TOutIter,
           typename RealType,
           typename TInputPixel,
           typename OutputPixelType,
-          bool doDilate>
+          bool doDilate,
+          typename TProgress>
 void
-doOneDimension(TInIter &          inputIterator,
-               TOutIter &         outputIterator,
-               ProgressReporter & progress,
-               const long         LineLength,
-               const unsigned     direction,
-               const bool         m_UseImageSpacing,
-               const RealType     image_scale,
-               const RealType     Sigma,
-               int                ParabolicAlgorithmChoice)
+doOneDimension(TInIter &                                inputIterator,
+               TOutIter &                               outputIterator,
+               TProgress &                              progress,
+               const long                               LineLength,
+               const unsigned                           direction,
+               const bool                               m_UseImageSpacing,
+               const RealType                           image_scale,
+               const RealType                           Sigma,
+               int                                      ParabolicAlgorithmChoice,
+               ParabolicLineScratch<RealType> &         scratch,
+               const ParabolicLineBorder<RealType> &    border = ParabolicLineBorder<RealType>(),
+               const ParabolicLineFunctions<RealType> & functions = ParabolicLineFunctions<RealType>(),
+               const unsigned int                       stride = 1)
 {
   enum ParabolicAlgorithm
   {
@@ -203,11 +1014,7 @@ doOneDimension(TInIter &          inputIterator,
     INTERSECTION = 2  // default
   };
 
-  //  using LineBufferType = typename std::vector<RealType>;
-
-  // message from M.Starring suggested performance gain using Array
-  // instead of std::vector.
-  using LineBufferType = typename itk::Array<RealType>;
+  using LineBufferType = typename ParabolicLineScratch<RealType>::LineBufferType;
   RealType iscale = 1.0;
   if (m_UseImageSpacing)
   {
@@ -226,7 +1033,72 @@ doOneDimension(TInIter &          inputIterator,
     }
   }
 
-  if (ParabolicAlgorithmChoice == CONTACTPOINT)
+  scratch.SetLineLength(LineLength);
+  LineBufferType & LineBuf = scratch.LineBuf;
+
+  // With a stride the output lines hold every stride-th result. A zero
+  // Sigma only decimates.
+  const auto decimate = [&LineBuf, LineLength, stride]() {
+    for (long j = 1, q = stride; stride > 1 && q < LineLength; ++j, q += stride)
+    {
+      LineBuf[j] = LineBuf[q];
+    }
+  };
+  if (Sigma <= 0)
+  {
+    ParabolicAlgorithmChoice = -1;
+  }
+
+  // input lines shorter than the buffer have a virtual border
+  const long inputLength = static_cast<long>(inputIterator.GetRegion().GetSize()[direction]);
+  const long readOffset = inputLength < LineLength ? border.Lower : 0;
+
+  // passes after the first read and write the same buffer, so a line
+  // that comes out unchanged needn't be written back, unless a
+  // function changes it on the way in or out
+  inputIterator.GoToBegin();
+  outputIterator.GoToBegin();
+  const bool inPlace = !inputIterator.IsAtEnd() && !outputIterator.IsAtEnd() &&
+                       static_cast<const void *>(&inputIterator.Value()) ==
+                         static_cast<const void *>(&outputIterator.Value()) &&
+                       functions.Empty();
+
+  if (ParabolicAlgorithmChoice < 0)
+  {
+    inputIterator.SetDirection(direction);
+    outputIterator.SetDirection(direction);
+    inputIterator.GoToBegin();
+    outputIterator.GoToBegin();
+
+    while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
+    {
+      long i = 0;
+      for (; i < readOffset; ++i)
+      {
+        LineBuf[i] = border.Value;
+      }
+      while (!inputIterator.IsAtEndOfLine())
+      {
+        LineBuf[i++] = static_cast<RealType>(inputIterator.Get());
+        ++inputIterator;
+      }
+      if (functions.Prologue)
+      {
+        functions.Prologue(&LineBuf[readOffset], static_cast<SizeValueType>(i - readOffset));
+      }
+      for (; i < LineLength; ++i)
+      {
+        LineBuf[i] = border.Value;
+      }
+      decimate();
+      ParabolicWriteLine(outputIterator, LineBuf, scratch, functions);
+
+      inputIterator.NextLine();
+      outputIterator.NextLine();
+      progress.CompletedPixel();
+    }
+  }
+  else if (ParabolicAlgorithmChoice == CONTACTPOINT)
   {
     // using the contact point algorithm
 
@@ -236,8 +1108,7 @@ doOneDimension(TInIter &          inputIterator,
     constexpr int  magnitudeSign = doDilate ? 1 : -1;
     const RealType magnitudeCP = (magnitudeSign * iscale * iscale) / (2.0 * Sigma);
 
-    LineBufferType LineBuf(LineLength);
-    LineBufferType tmpLineBuf(LineLength);
+    LineBufferType & tmpLineBuf = scratch.tmpLineBuf;
     inputIterator.SetDirection(direction);
     outputIterator.SetDirection(direction);
     inputIterator.GoToBegin();
@@ -249,20 +1120,41 @@ doOneDimension(TInIter &          inputIterator,
       // fetch the line into the buffer - this methodology is like
       // the gaussian filters
 
-      unsigned int i = 0;
+      long i = 0;
+      for (; i < readOffset; ++i)
+      {
+        LineBuf[i] = border.Value;
+      }
       while (!inputIterator.IsAtEndOfLine())
       {
         LineBuf[i++] = static_cast<RealType>(inputIterator.Get());
         ++inputIterator;
       }
+      if (functions.Prologue)
+      {
+        functions.Prologue(&LineBuf[readOffset], static_cast<SizeValueType>(i - readOffset));
+      }
+      for (; i < LineLength; ++i)
+      {
+        LineBuf[i] = border.Value;
+      }
 
-      DoLineCP<LineBufferType, RealType, TInputPixel, doDilate>(LineBuf, tmpLineBuf, magnitudeCP);
-      // copy the line back
-      unsigned int j = 0;
-      while (!outputIterator.IsAtEndOfLine())
+      bool                   unchanged;
+      const LineBufferType & result = ParabolicProcessLine<RealType, doDilate>(
+        scratch,
+        CONTACTPOINT,
+        magnitudeCP,
+        [&]() {
+          // both sweeps need every position, so decimate afterwards
+          DoLineCP<LineBufferType, RealType, doDilate>(LineBuf, tmpLineBuf, magnitudeCP);
+          decimate();
+        },
+        unchanged,
+        stride);
+      // copy the line back, unless it is already there
+      if (!(unchanged && inPlace))
       {
-        outputIterator.Set(static_cast<OutputPixelType>(LineBuf[j++]));
-        ++outputIterator;
+        ParabolicWriteLine(outputIterator, result, scratch, functions);
       }
 
       // now onto the next line
@@ -274,13 +1166,12 @@ doOneDimension(TInIter &          inputIterator,
   else
   {
     // using the Intersection algorithm
-    using IndexBufferType = typename itk::Array<int>;
+    using IndexBufferType = typename ParabolicLineScratch<RealType>::IndexBufferType;
 
-    const RealType  magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
-    LineBufferType  LineBuf(LineLength);
-    LineBufferType  Fbuf(LineLength);
-    IndexBufferType Vbuf(LineLength);
-    LineBufferType  Zbuf(LineLength + 1);
+    const RealType    magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
+    LineBufferType &  Fbuf = scratch.Fbuf;
+    IndexBufferType & Vbuf = scratch.Vbuf;
+    LineBufferType &  Zbuf = scratch.Zbuf;
 
     inputIterator.SetDirection(direction);
     outputIterator.SetDirection(direction);
@@ -293,20 +1184,39 @@ doOneDimension(TInIter &          inputIterator,
       // fetch the line into the buffer - this methodology is like
       // the gaussian filters
 
-      unsigned int i = 0;
+      long i = 0;
+      for (; i < readOffset; ++i)
+      {
+        LineBuf[i] = border.Value;
+      }
       while (!inputIterator.IsAtEndOfLine())
       {
         LineBuf[i++] = static_cast<RealType>(inputIterator.Get());
         ++inputIterator;
       }
-      DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
-        LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt);
-      // copy the line back
-      unsigned int j = 0;
-      while (!outputIterator.IsAtEndOfLine())
+      if (functions.Prologue)
       {
-        outputIterator.Set(static_cast<OutputPixelType>(LineBuf[j++]));
-        ++outputIterator;
+        functions.Prologue(&LineBuf[readOffset], static_cast<SizeValueType>(i - readOffset));
+      }
+      for (; i < LineLength; ++i)
+      {
+        LineBuf[i] = border.Value;
+      }
+      bool                   unchanged;
+      const LineBufferType & result = ParabolicProcessLine<RealType, doDilate>(
+        scratch,
+        INTERSECTION,
+        magnitudeInt,
+        [&]() {
+          DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
+            LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt, stride);
+        },
+        unchanged,
+        stride);
+      // copy the line back, unless it is already there
+      if (!(unchanged && inPlace))
+      {
+        ParabolicWriteLine(outputIterator, result, scratch, functions);
       }
 
       // now onto the next line
@@ -316,5 +1226,303 @@ doOneDimension(TInIter &          inputIterator,
     }
   }
 }
+
+// Convenience version that allocates its own line buffers
+template <typename TInIter,
+          typename TOutIter,
+          typename RealType,
+          typename TInputPixel,
+          typename OutputPixelType,
+          bool doDilate,
+          typename TProgress>
+void
+doOneDimension(TInIter &          inputIterator,
+               TOutIter &         outputIterator,
+               TProgress &        progress,
+               const long         LineLength,
+               const unsigned     direction,
+               const bool         m_UseImageSpacing,
+               const RealType     image_scale,
+               const RealType     Sigma,
+               int                ParabolicAlgorithmChoice)
+{
+  ParabolicLineScratch<RealType> scratch;
+  doOneDimension<TInIter, TOutIter, RealType, TInputPixel, OutputPixelType, doDilate>(inputIterator,
+                                                                                    outputIterator,
+                                                                                    progress,
+                                                                                    LineLength,
+                                                                                    direction,
+                                                                                    m_UseImageSpacing,
+                                                                                    image_scale,
+                                                                                    Sigma,
+                                                                                    ParabolicAlgorithmChoice,
+                                                                                    scratch);
+}
+
+// doOneDimension for a pass restricted to a mask. Samples where the
+// mask is zero take no part in the envelope and are not written,
+// unless copyOutside is set (the first pass, when the output is not
+// the input), in which case they are copied through unchanged. Lines
+// with no sample inside the mask are not read at all then. The
+// functions apply to the samples inside the mask only. A zero Sigma
+// only applies the functions. Always uses the intersection algorithm,
+// whose envelope copes with the gaps.
+template <typename TInIter, typename TOutIter, typename TMaskIter, typename RealType, bool doDilate, typename TProgress>
+void
+doOneDimensionMasked(TInIter &                                inputIterator,
+                     TOutIter &                               outputIterator,
+                     TMaskIter &                              maskIterator,
+                     TProgress &                              progress,
+                     const unsigned                           direction,
+                     const bool                               m_UseImageSpacing,
+                     const RealType                           image_scale,
+                     const RealType                           Sigma,
+                     const bool                               copyOutside,
+                     ParabolicLineScratch<RealType> &         scratch,
+                     const ParabolicLineFunctions<RealType> & functions)
+{
+  using LineBufferType = typename ParabolicLineScratch<RealType>::LineBufferType;
+  using IndexBufferType = typename ParabolicLineScratch<RealType>::IndexBufferType;
+  using OutputPixelType = typename TOutIter::PixelType;
+
+  const RealType iscale = m_UseImageSpacing ? image_scale : 1.0;
+  const RealType magnitude = (iscale * iscale) / (2.0 * Sigma);
+
+  const long LineLength = static_cast<long>(inputIterator.GetRegion().GetSize()[direction]);
+  scratch.SetLineLength(LineLength);
+  if (static_cast<long>(scratch.Pbuf.size()) != LineLength)
+  {
+    scratch.Pbuf.SetSize(LineLength);
+  }
+  LineBufferType &  LineBuf = scratch.LineBuf;
+  LineBufferType &  tmpLineBuf = scratch.tmpLineBuf;
+  IndexBufferType & Pbuf = scratch.Pbuf;
+
+  inputIterator.SetDirection(direction);
+  outputIterator.SetDirection(direction);
+  maskIterator.SetDirection(direction);
+  inputIterator.GoToBegin();
+  outputIterator.GoToBegin();
+  maskIterator.GoToBegin();
+  for (; !inputIterator.IsAtEnd() && !outputIterator.IsAtEnd();
+       inputIterator.NextLine(), outputIterator.NextLine(), maskIterator.NextLine(), progress.CompletedPixel())
+  {
+    size_t n = 0;
+    for (long i = 0; !maskIterator.IsAtEndOfLine(); ++i, ++maskIterator)
+    {
+      if (maskIterator.Get())
+      {
+        Pbuf[n++] = static_cast<int>(i);
+      }
+    }
+    if (n == 0 && !copyOutside)
+    {
+      continue;
+    }
+
+    // the whole line is read before any of it is written, so the
+    // input can be the output
+    for (long i = 0; !inputIterator.IsAtEndOfLine(); ++i, ++inputIterator)
+    {
+      tmpLineBuf[i] = static_cast<RealType>(inputIterator.Get());
+    }
+    for (size_t j = 0; j < n; ++j)
+    {
+      LineBuf[j] = tmpLineBuf[Pbuf[j]];
+    }
+    if (functions.Prologue && n > 0)
+    {
+      functions.Prologue(LineBuf.data_block(), n);
+    }
+    if (Sigma > 0 && n > 1)
+    {
+      DoLineIntAlgAt<LineBufferType, IndexBufferType, RealType, doDilate>(
+        LineBuf, Pbuf, n, scratch.Fbuf, scratch.Vbuf, scratch.Zbuf, magnitude);
+    }
+    if (functions.Epilogue && n > 0)
+    {
+      functions.Epilogue(LineBuf.data_block(), n);
+    }
+
+    size_t j = 0;
+    for (long i = 0; !outputIterator.IsAtEndOfLine(); ++i, ++outputIterator)
+    {
+      if (j < n && Pbuf[j] == i)
+      {
+        outputIterator.Set(static_cast<OutputPixelType>(LineBuf[j++]));
+      }
+      else if (copyOutside)
+      {
+        outputIterator.Set(static_cast<OutputPixelType>(tmpLineBuf[i]));
+      }
+    }
+  }
+}
+
+// The line kernel applied to a line of LineLength pixels all equal
+// to value, left in scratch.LineBuf.
+template <typename RealType, typename TInputPixel, bool doDilate>
+void
+ParabolicConstantLine(ParabolicLineScratch<RealType> & scratch,
+                      const long                       LineLength,
+                      const RealType                   value,
+                      const bool                       useImageSpacing,
+                      const RealType                   image_scale,
+                      const RealType                   Sigma,
+                      int                              ParabolicAlgorithmChoice)
+{
+  using LineBufferType = typename ParabolicLineScratch<RealType>::LineBufferType;
+  using IndexBufferType = typename ParabolicLineScratch<RealType>::IndexBufferType;
+
+  const RealType iscale = useImageSpacing ? image_scale : 1.0;
+  if (ParabolicAlgorithmChoice == 0)
+  {
+    ParabolicAlgorithmChoice = (2.0 * Sigma) < 0.2 ? 1 : 2;
+  }
+
+  scratch.SetLineLength(LineLength);
+  for (long i = 0; i < LineLength; ++i)
+  {
+    scratch.LineBuf[i] = value;
+  }
+  if (ParabolicAlgorithmChoice == 1)
+  {
+    constexpr int  magnitudeSign = doDilate ? 1 : -1;
+    const RealType magnitudeCP = (magnitudeSign * iscale * iscale) / (2.0 * Sigma);
+    DoLineCP<LineBufferType, RealType, doDilate>(scratch.LineBuf, scratch.tmpLineBuf, magnitudeCP);
+  }
+  else
+  {
+    const RealType magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
+    DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
+      scratch.LineBuf, scratch.Fbuf, scratch.Vbuf, scratch.Zbuf, magnitudeInt);
+  }
+}
+
+// The first pass over region of an output that extends beyond its
+// input by a virtual border. Lines along direction that cross the
+// input are read with a constant extension. The rest of region lies
+// wholly in the border and gets the result for a constant line. An
+// all zero scale is a copy of the input with the same border.
+// The border value goes through the prologue like the input does.
+template <typename TInputImage, typename TOutputImage, typename RealType, bool doDilate, typename TProgress>
+void
+ParabolicFirstPassWithBorder(const TInputImage *                       inputImage,
+                             TOutputImage *                            outputImage,
+                             const typename TOutputImage::RegionType & region,
+                             TProgress &                               progress,
+                             const unsigned                            direction,
+                             const bool                                useImageSpacing,
+                             const RealType                            Sigma,
+                             const int                                 ParabolicAlgorithmChoice,
+                             ParabolicLineScratch<RealType> &          scratch,
+                             const typename TInputImage::PixelType     borderValue,
+                             const ParabolicLineFunctions<RealType> &  functions = ParabolicLineFunctions<RealType>())
+{
+  using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
+  using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using RegionType = typename TOutputImage::RegionType;
+
+  RegionType inputRegion = region;
+  const bool crossesInput = inputRegion.Crop(inputImage->GetBufferedRegion());
+
+  if (direction >= TOutputImage::ImageDimension)
+  {
+    // copy
+    const auto     copyValue = [&](const RealType v) { return functions.ApplyEpilogue(functions.ApplyPrologue(v)); };
+    const RealType mappedBorder = copyValue(static_cast<RealType>(borderValue));
+    const auto     fillBorder = [&](const RegionType & slab) {
+      ImageRegionIterator<TOutputImage> it(outputImage, slab);
+      for (; !it.IsAtEnd(); ++it)
+      {
+        it.Set(static_cast<OutputPixelType>(mappedBorder));
+      }
+    };
+    if (!crossesInput)
+    {
+      fillBorder(region);
+      return;
+    }
+    ImageRegionConstIterator<TInputImage> inIt(inputImage, inputRegion);
+    ImageRegionIterator<TOutputImage>     outIt(outputImage, inputRegion);
+    for (; !inIt.IsAtEnd(); ++inIt, ++outIt)
+    {
+      outIt.Set(static_cast<OutputPixelType>(copyValue(static_cast<RealType>(inIt.Get()))));
+    }
+    ParabolicForEachOutside(region, inputRegion, fillBorder);
+    return;
+  }
+
+  const long     LineLength = region.GetSize(direction);
+  const RealType image_scale = inputImage->GetSpacing()[direction];
+
+  // whole lines of region that cross the input
+  RegionType lineRegion = inputRegion;
+  if (crossesInput)
+  {
+    lineRegion.SetIndex(direction, region.GetIndex(direction));
+    lineRegion.SetSize(direction, region.GetSize(direction));
+
+    ParabolicLineBorder<RealType> border;
+    border.Lower = inputRegion.GetIndex(direction) - region.GetIndex(direction);
+    border.Value = functions.ApplyPrologue(static_cast<RealType>(borderValue));
+
+    InputConstIteratorType inputIterator(inputImage, inputRegion);
+    OutputIteratorType     outputIterator(outputImage, lineRegion);
+    doOneDimension<InputConstIteratorType,
+                   OutputIteratorType,
+                   RealType,
+                   typename TInputImage::PixelType,
+                   OutputPixelType,
+                   doDilate>(inputIterator,
+                             outputIterator,
+                             progress,
+                             LineLength,
+                             direction,
+                             useImageSpacing,
+                             image_scale,
+                             Sigma,
+                             ParabolicAlgorithmChoice,
+                             scratch,
+                             border,
+                             functions);
+  }
+
+  // the other lines are all the same constant line, processed once.
+  // Going through the kernel, rather than setting the border value,
+  // keeps the rounding the same as for a padded input.
+  ParabolicConstantLine<RealType, typename TInputImage::PixelType, doDilate>(
+    scratch,
+    LineLength,
+    functions.ApplyPrologue(static_cast<RealType>(borderValue)),
+    useImageSpacing,
+    image_scale,
+    Sigma,
+    ParabolicAlgorithmChoice);
+  if (functions.Epilogue)
+  {
+    functions.Epilogue(scratch.LineBuf.data_block(), static_cast<SizeValueType>(LineLength));
+  }
+  const auto fillLines = [&](const RegionType & slab) {
+    OutputIteratorType it(outputImage, slab);
+    it.SetDirection(direction);
+    for (it.GoToBegin(); !it.IsAtEnd(); it.NextLine())
+    {
+      for (long i = 0; !it.IsAtEndOfLine(); ++i, ++it)
+      {
+        it.Set(static_cast<OutputPixelType>(scratch.LineBuf[i]));
+      }
+    }
+  };
+  if (crossesInput)
+  {
+    ParabolicForEachOutside(region, lineRegion, fillLines);
+  }
+  else
+  {
+    fillLines(region);
+  }
+}
 } // namespace itk
 #endif
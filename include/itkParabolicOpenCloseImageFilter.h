@@ -18,9 +18,11 @@
 #ifndef itkParabolicOpenCloseImageFilter_h
 #define itkParabolicOpenCloseImageFilter_h
 
+#include <vector>
 #include "itkImageToImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
@@ -30,7 +32,15 @@ namespace itk
  * operations  with parabolic structuring elements.
  *
  * This filter doesn't use the erode/dilate classes directly so
- * that multiple image copies aren't necessary.
+ * that multiple image copies aren't necessary. Directions with a
+ * scale of zero are skipped in both stages.
+ *
+ * As in ParabolicErodeDilateImageFilter, a known value range limits
+ * the input requested to a margin around the output requested region.
+ * The margin is twice that of a single erosion or dilation, since the
+ * second stage depends on a margin of the first. It is computed in a
+ * buffer of its own, so the output buffered region is the requested
+ * region.
  *
  * This filter is threaded. Threading mechanism derived from
  * SignedMaurerDistanceMap extensions by Gaetan Lehman
@@ -114,6 +124,44 @@ public:
   itkGetConstReferenceMacro(UseImageSpacing, bool);
   itkBooleanMacro(UseImageSpacing);
 
+  /**
+   * Set/Get the range (maximum - minimum) of the input values. The
+   * default of 0 uses the range of the pixel type for integer pixels
+   * and requests whole lines for floating point pixels. See
+   * ParabolicErodeDilateImageFilter::SetValueRange.
+   */
+  itkSetMacro(ValueRange, ScalarRealType);
+  itkGetConstReferenceMacro(ValueRange, ScalarRealType);
+
+  using OutputPixelContainerType = typename OutputImageType::PixelContainer;
+
+  /**
+   * Set/Get a pixel container to use as the output buffer instead of
+   * allocating one. See
+   * ParabolicErodeDilateImageFilter::SetOutputPixelContainer.
+   */
+  itkSetObjectMacro(OutputPixelContainer, OutputPixelContainerType);
+  itkGetModifiableObjectMacro(OutputPixelContainer, OutputPixelContainerType);
+
+  /**
+   * Set/Get a virtual border added around the input before the first
+   * stage. See ParabolicErodeDilateImageFilter::SetBorderPad. The
+   * output covers the padded region; ParabolicOpenCloseSafeBorderImageFilter
+   * crops it back.
+   */
+  itkSetMacro(BorderPadLowerBound, InputSizeType);
+  itkGetConstReferenceMacro(BorderPadLowerBound, InputSizeType);
+  itkSetMacro(BorderPadUpperBound, InputSizeType);
+  itkGetConstReferenceMacro(BorderPadUpperBound, InputSizeType);
+  void
+  SetBorderPad(const InputSizeType & pad)
+  {
+    this->SetBorderPadLowerBound(pad);
+    this->SetBorderPadUpperBound(pad);
+  }
+  itkSetMacro(BorderValue, PixelType);
+  itkGetConstReferenceMacro(BorderValue, PixelType);
+
   enum ParabolicAlgorithm
   {
     NOCHOICE = 0,     // decices based on scale - experimental
@@ -129,6 +177,15 @@ public:
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** Predict the peak memory and the work of an update with the
+   * current settings, for an input of the given size and spacing.
+   * Both stages work in the output buffer, which isn't counted when
+   * it is a caller supplied container. */
+  ParabolicCostEstimate
+  EstimateCost(const InputSizeType & size, const SpacingType & spacing) const;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
@@ -155,10 +212,20 @@ protected:
   void
   ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
 
+  void
+  GenerateOutputInformation() override;
+
   void
   GenerateInputRequestedRegion() override;
 
-  // Override since the filter produces the entire dataset.
+  // the declared value range, or the range of the pixel type, or 0 if
+  // neither is known
+  double
+  GetInfluenceRange() const;
+
+  // Override since the filter produces whole lines along every
+  // direction with a non zero scale when the range is unknown. A
+  // margin is not added to the output, since its pixels are not exact.
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
@@ -167,9 +234,26 @@ protected:
 private:
   RadiusType m_Scale;
 
-  int  m_CurrentDimension;
-  int  m_Stage;
-  bool m_UseImageSpacing;
+  // directions processed in each stage, in order, and the one
+  // currently being processed. ImageDimension means a plain copy.
+  std::vector<unsigned int> m_PassAxes;
+  unsigned int              m_CurrentPass;
+  unsigned int              m_CurrentDimension;
+  int                       m_Stage;
+  bool                      m_UseImageSpacing;
+  ScalarRealType            m_ValueRange;
+
+  typename OutputPixelContainerType::Pointer m_OutputPixelContainer;
+  InputSizeType                              m_BorderPadLowerBound;
+  InputSizeType                              m_BorderPadUpperBound;
+  PixelType                                  m_BorderValue;
+
+  // line buffers for each work unit, kept between updates
+  ParabolicLineScratchSet<RealType, ImageDimension> m_LineScratch;
+
+  // the image the passes write: the output, or a buffer that also
+  // holds the margin around the requested region
+  typename TOutputImage::Pointer m_PassImage;
 };
 } // end namespace itk
 
@@ -18,6 +18,7 @@
 #ifndef itkParabolicOpenCloseImageFilter_hxx
 #define itkParabolicOpenCloseImageFilter_hxx
 
+#include "itkImageAlgorithm.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 
@@ -42,8 +43,15 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ParabolicOpenC
   // needs to be selected according to erosion/dilation
   m_UseImageSpacing = false;
   m_ParabolicAlgorithm = INTERSECTION;
+  m_Scale.Fill(0);
   m_Stage = 1; // indicate whether we are on the first pass or the
   // second
+  m_CurrentDimension = 0;
+  m_CurrentPass = 0;
+  m_ValueRange = 0;
+  m_BorderPadLowerBound.Fill(0);
+  m_BorderPadUpperBound.Fill(0);
+  m_BorderValue = NumericTraits<PixelType>::ZeroValue();
 
   this->DynamicMultiThreadingOff();
 }
@@ -58,8 +66,9 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::SplitRequested
   // Get the output pointer
   OutputImageType * outputPtr = this->GetOutput();
 
-  // Initialize the splitRegion to the output requested region
-  splitRegion = outputPtr->GetRequestedRegion();
+  // Initialize the splitRegion to the region the passes write: the
+  // output requested region with its margin
+  splitRegion = m_PassImage ? m_PassImage->GetBufferedRegion() : outputPtr->GetRequestedRegion();
 
   const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
 
@@ -117,6 +126,21 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::SetScale(Scala
   this->SetScale(s);
 }
 
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+void
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  // a virtual border extends the output beyond the input
+  OutputImageType * out = this->GetOutput();
+  if (out && ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+  {
+    out->SetLargestPossibleRegion(
+      ParabolicPadRegion(out->GetLargestPossibleRegion(), m_BorderPadLowerBound, m_BorderPadUpperBound));
+  }
+}
+
 #if 1
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
 void
@@ -126,11 +150,30 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateInputR
   // copy the output requested region to the input requested region
   Superclass::GenerateInputRequestedRegion();
 
-  // This filter needs all of the input
   InputImagePointer image = const_cast<InputImageType *>(this->GetInput());
+  if (image && ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+  {
+    // the border part of the output needs no input
+    typename InputImageType::RegionType region = image->GetRequestedRegion();
+    if (!region.Crop(image->GetLargestPossibleRegion()))
+    {
+      region = image->GetLargestPossibleRegion();
+    }
+    image->SetRequestedRegion(region);
+  }
+
+  // The passes compute the margin for both stages around the output
+  // requested region, or whole lines, so the input is needed over it
+  // too
   if (image)
   {
-    image->SetRequestedRegion(this->GetInput()->GetLargestPossibleRegion());
+    image->SetRequestedRegion(ParabolicEnlargeByInfluence(image->GetRequestedRegion(),
+                                                          image->GetLargestPossibleRegion(),
+                                                          m_Scale,
+                                                          image->GetSpacing(),
+                                                          m_UseImageSpacing,
+                                                          this->GetInfluenceRange(),
+                                                          2));
   }
 }
 
@@ -143,12 +186,25 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::EnlargeOutputR
 {
   auto * out = dynamic_cast<TOutputImage *>(output);
 
-  if (out)
+  if (out && this->GetInfluenceRange() <= 0)
   {
-    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+    // whole lines are exact throughout
+    out->SetRequestedRegion(
+      ParabolicEnlargeAlongActiveAxes(out->GetRequestedRegion(), out->GetLargestPossibleRegion(), m_Scale));
   }
 }
 
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+double
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GetInfluenceRange() const
+{
+  if (m_ValueRange > 0)
+  {
+    return static_cast<double>(m_ValueRange);
+  }
+  return ParabolicPixelTypeRange<PixelType>();
+}
+
 #endif
 
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
@@ -170,8 +226,30 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateData()
 
   // const unsigned int imageDimension = inputImage->GetImageDimension();
 
-  outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
-  outputImage->Allocate();
+  if (!ParabolicUseOutputContainer(outputImage.GetPointer(), m_OutputPixelContainer.GetPointer()))
+  {
+    outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
+    outputImage->Allocate();
+  }
+
+  // The pixels in the margin around the requested region are not
+  // exact, so the passes compute them in a buffer of their own, and
+  // the output keeps only the requested region.
+  const OutputImageRegionType passRegion = ParabolicEnlargeByInfluence(outputImage->GetRequestedRegion(),
+                                                                       outputImage->GetLargestPossibleRegion(),
+                                                                       m_Scale,
+                                                                       outputImage->GetSpacing(),
+                                                                       m_UseImageSpacing,
+                                                                       this->GetInfluenceRange(),
+                                                                       2);
+  m_PassImage = outputImage;
+  if (passRegion != outputImage->GetRequestedRegion())
+  {
+    m_PassImage = OutputImageType::New();
+    m_PassImage->CopyInformation(outputImage);
+    m_PassImage->SetRegions(passRegion);
+    m_PassImage->Allocate();
+  }
 
   typename ImageSource<OutputImageType>::ThreadStruct str;
   str.Filter = this;
@@ -180,57 +258,49 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateData()
   multithreader->SetNumberOfWorkUnits(nbthreads);
   multithreader->SetSingleMethod(this->ThreaderCallback, &str);
 
-  // multithread the execution
+  // line buffers are sized here, so the work units never allocate
+  m_LineScratch.SetNumberOfWorkUnits(nbthreads);
+  m_LineScratch.SetLineLengths(passRegion.GetSize());
+
+  // multithread the execution, one pass per direction with a non
+  // zero scale in each stage
+  m_PassAxes = ParabolicActiveAxes(m_Scale);
+  if (m_PassAxes.empty())
+  {
+    // all scales are 0 - a single pass copies the input
+    m_Stage = 1;
+    m_CurrentPass = 0;
+    m_CurrentDimension = ImageDimension;
+    multithreader->SingleMethodExecute();
+  }
 
   // multithread the execution - stage 1
   m_Stage = 1;
-
-  for (unsigned int d = 0; d < ImageDimension; d++)
+  for (unsigned int p = 0; p < m_PassAxes.size(); p++)
   {
-    m_CurrentDimension = d;
+    m_CurrentPass = p;
+    m_CurrentDimension = m_PassAxes[p];
     multithreader->SingleMethodExecute();
   }
 
   // multithread the execution - stage 2
   m_Stage = 2;
-  for (unsigned int d = 0; d < ImageDimension; d++)
+  for (unsigned int p = 0; p < m_PassAxes.size(); p++)
   {
-    m_CurrentDimension = d;
+    m_CurrentPass = m_PassAxes.size() + p;
+    m_CurrentDimension = m_PassAxes[p];
     multithreader->SingleMethodExecute();
   }
 
   m_Stage = 1;
-
-#if 0
-  // Set up the multithreaded processing
-  typename ImageSource< TOutputImage >::ThreadStruct str;
-  str.Filter = this;
-  this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
-  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
-
-  // multithread the execution - stage 1
-  m_Stage = 1;
-  for ( unsigned int d = 0; d < ImageDimension; d++ )
-    {
-    m_CurrentDimension = d;
-    this->GetMultiThreader()->SingleMethodExecute();
-    }
-  // swap over the parameters controlling erosion/dilation
-  m_Extreme = m_Extreme2;
-  m_MagnitudeSign = m_MagnitudeSign2;
-
-  // multithread the execution - stage 2
-  m_Stage = 2;
-  for ( unsigned int d = 0; d < ImageDimension; d++ )
-    {
-    m_CurrentDimension = d;
-    this->GetMultiThreader()->SingleMethodExecute();
-    }
-  // swap them back
-  m_Extreme = m_Extreme1;
-  m_MagnitudeSign = m_MagnitudeSign1;
-  m_Stage = 1;
-#endif
+  if (m_PassImage != outputImage)
+  {
+    ImageAlgorithm::Copy(m_PassImage.GetPointer(),
+                         outputImage.GetPointer(),
+                         outputImage->GetRequestedRegion(),
+                         outputImage->GetRequestedRegion());
+  }
+  m_PassImage = nullptr;
 }
 
 ////////////////////////////////////////////////////////////
@@ -253,10 +323,10 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
     }
   }
 
-  float progressPerDimension = 1.0 / ImageDimension;
+  float progressPerDimension = 1.0 / std::max<size_t>(2 * m_PassAxes.size(), 1);
 
   ProgressReporter progress(
-    this, threadId, numberOfRows, 30, m_CurrentDimension * progressPerDimension, progressPerDimension);
+    this, threadId, numberOfRows, 30, m_CurrentPass * progressPerDimension, progressPerDimension);
 
   using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
   using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
@@ -267,89 +337,76 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
   using RegionType = ImageRegion<TInputImage::ImageDimension>;
 
   typename TInputImage::ConstPointer inputImage(this->GetInput());
-  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+  // the output, or the buffer holding the margin too
+  typename TOutputImage::Pointer outputImage(m_PassImage);
 
-  // const unsigned int imageDimension = inputImage->GetImageDimension();
-
-  // outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  // outputImage->Allocate();
   RegionType region = outputRegionForThread;
 
-  InputConstIteratorType  inputIterator(inputImage, region);
-  OutputIteratorType      outputIterator(outputImage, region);
-  OutputConstIteratorType inputIteratorStage2(outputImage, region);
+  if (m_CurrentPass == 0 && ParabolicHasBorder(m_BorderPadLowerBound, m_BorderPadUpperBound))
+  {
+    // first pass of stage 1, or the copy, extends the input
+    const unsigned int d = m_CurrentDimension;
+    ParabolicFirstPassWithBorder<TInputImage, TOutputImage, RealType, !DoOpen>(
+      inputImage.GetPointer(),
+      outputImage.GetPointer(),
+      region,
+      progress,
+      d,
+      this->m_UseImageSpacing,
+      d < ImageDimension ? this->m_Scale[d] : 0,
+      m_ParabolicAlgorithm,
+      m_LineScratch.Get(threadId, std::min(d, ImageDimension - 1)),
+      m_BorderValue);
+    return;
+  }
 
-  if (m_Stage == 1)
+  if (m_CurrentDimension == ImageDimension)
   {
-    // deal with the first dimension - this should be copied to the
-    // output if the scale is 0
-    if (m_CurrentDimension == 0)
-    {
-      if (m_Scale[0] > 0)
-      {
-        // Perform as normal
-        //     RealType magnitude = 1.0/(2.0 * m_Scale[0]);
-        unsigned long LineLength = region.GetSize()[0];
-        RealType      image_scale = this->GetInput()->GetSpacing()[0];
-
-        doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, !DoOpen>(
-          inputIterator,
-          outputIterator,
-          progress,
-          LineLength,
-          0,
-          this->m_UseImageSpacing,
-          image_scale,
-          this->m_Scale[0],
-          m_ParabolicAlgorithm);
-      }
-      else
-      {
-        // copy to output
-        using InItType = ImageRegionConstIterator<TInputImage>;
-        using OutItType = ImageRegionIterator<TOutputImage>;
-
-        InItType  InIt(inputImage, region);
-        OutItType OutIt(outputImage, region);
-        while (!InIt.IsAtEnd())
-        {
-          OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
-          ++InIt;
-          ++OutIt;
-        }
-      }
-    }
-    else
+    // copy to output
+    using InItType = ImageRegionConstIterator<TInputImage>;
+    using OutItType = ImageRegionIterator<TOutputImage>;
+
+    InItType  InIt(inputImage, region);
+    OutItType OutIt(outputImage, region);
+    while (!InIt.IsAtEnd())
     {
-      if (m_Scale[m_CurrentDimension] > 0)
-      {
-        // now deal with the other dimensions for first stage
-        unsigned long LineLength = region.GetSize()[m_CurrentDimension];
-        RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
-
-        doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, !DoOpen>(
-          inputIteratorStage2,
-          outputIterator,
-          progress,
-          LineLength,
-          m_CurrentDimension,
-          this->m_UseImageSpacing,
-          image_scale,
-          this->m_Scale[m_CurrentDimension],
-          m_ParabolicAlgorithm);
-      }
+      OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
+      ++InIt;
+      ++OutIt;
     }
+    return;
   }
-  else
+
+  OutputIteratorType               outputIterator(outputImage, region);
+  OutputConstIteratorType          inputIteratorStage2(outputImage, region);
+  ParabolicLineScratch<RealType> & scratch = m_LineScratch.Get(threadId, m_CurrentDimension);
+
+  unsigned long LineLength = region.GetSize()[m_CurrentDimension];
+  RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
+
+  if (m_Stage == 1)
   {
-    // deal with the other dimensions for second stage
-    if (m_Scale[m_CurrentDimension] > 0)
+    // the first pass reads from the input, the others work in place
+    // on the output
+    if (m_CurrentPass == 0)
     {
-      // RealType magnitude = 1.0/(2.0 * m_Scale[dd]);
-      unsigned long LineLength = region.GetSize()[m_CurrentDimension];
-      RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
+      InputConstIteratorType inputIterator(inputImage, region);
 
-      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, DoOpen>(
+      doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, !DoOpen>(
+        inputIterator,
+        outputIterator,
+        progress,
+        LineLength,
+        m_CurrentDimension,
+        this->m_UseImageSpacing,
+        image_scale,
+        this->m_Scale[m_CurrentDimension],
+        m_ParabolicAlgorithm,
+        scratch);
+    }
+    else
+    {
+      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, !DoOpen>(
         inputIteratorStage2,
         outputIterator,
         progress,
@@ -358,9 +415,55 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
         this->m_UseImageSpacing,
         image_scale,
         this->m_Scale[m_CurrentDimension],
-        m_ParabolicAlgorithm);
+        m_ParabolicAlgorithm,
+        scratch);
     }
   }
+  else
+  {
+    // deal with the other dimensions for second stage
+    doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, DoOpen>(
+      inputIteratorStage2,
+      outputIterator,
+      progress,
+      LineLength,
+      m_CurrentDimension,
+      this->m_UseImageSpacing,
+      image_scale,
+      this->m_Scale[m_CurrentDimension],
+      m_ParabolicAlgorithm,
+      scratch);
+  }
+}
+
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+ParabolicCostEstimate
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::EstimateCost(const InputSizeType & size,
+                                                                               const SpacingType &   spacing) const
+{
+  OutputSizeType outputSize;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    outputSize[d] = size[d] + m_BorderPadLowerBound[d] + m_BorderPadUpperBound[d];
+  }
+  const SizeValueType outputBytes = ParabolicImageBytes<OutputPixelType>(outputSize);
+
+  ParabolicCostEstimate cost;
+  if (!m_OutputPixelContainer)
+  {
+    cost.PeakBytes += outputBytes;
+  }
+  cost.PeakBytes += ParabolicLineScratchBytes<RealType>(outputSize, this->GetNumberOfWorkUnits());
+  // an erosion and a dilation
+  const double passes = ParabolicPassOperations(
+    outputSize, m_Scale, spacing, m_UseImageSpacing, m_ParabolicAlgorithm, this->GetInfluenceRange());
+  cost.Operations = 2 * passes;
+  if (ParabolicActiveAxes(m_Scale).empty())
+  {
+    // a copy
+    cost.Operations = static_cast<double>(outputBytes / sizeof(OutputPixelType));
+  }
+  return cost;
 }
 
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
@@ -376,6 +479,12 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::PrintSelf(std:
   {
     os << "Scale in voxels: " << m_Scale << std::endl;
   }
+  os << indent << "ValueRange: " << m_ValueRange << std::endl;
+  os << indent << "BorderPadLowerBound: " << m_BorderPadLowerBound << std::endl;
+  os << indent << "BorderPadUpperBound: " << m_BorderPadUpperBound << std::endl;
+  os << indent << "BorderValue: " << static_cast<typename NumericTraits<PixelType>::PrintType>(m_BorderValue)
+     << std::endl;
+  itkPrintSelfObjectMacro(OutputPixelContainer);
 }
 } // namespace itk
 #endif
@@ -20,9 +20,7 @@
 
 #include "itkParabolicOpenCloseImageFilter.h"
 #include "itkCropImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkCastImageFilter.h"
-#include "itkStatisticsImageFilter.h"
 
 /* this class implements padding and cropping, so we don't just
  * inherit from the OpenCloseImageFitler */
@@ -117,6 +115,26 @@ public:
 
   itkBooleanMacro(UseImageSpacing);
 
+  /**
+   * Set/Get the range (maximum - minimum) of the input values. See
+   * ParabolicOpenCloseImageFilter::SetValueRange.
+   */
+  void
+  SetValueRange(ScalarRealType range)
+  {
+    if (range != this->GetValueRange())
+    {
+      this->m_MorphFilt->SetValueRange(range);
+      this->Modified();
+    }
+  }
+
+  ScalarRealType
+  GetValueRange() const
+  {
+    return (this->m_MorphFilt->GetValueRange());
+  }
+
   itkSetMacro(SafeBorder, bool);
   itkGetConstReferenceMacro(SafeBorder, bool);
   itkBooleanMacro(SafeBorder);
@@ -137,6 +155,26 @@ public:
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  using SizeType = typename TInputImage::SizeType;
+  using SpacingType = typename TInputImage::SpacingType;
+
+  /** The border the last update added below and above the input along
+   * each direction, sized from the values near each side. */
+  itkGetConstReferenceMacro(BorderPadLowerBoundUsed, SizeType);
+  itkGetConstReferenceMacro(BorderPadUpperBoundUsed, SizeType);
+
+  /**
+   * Predict the peak memory and the work of an update with the current
+   * settings, for an input of the given size and spacing. The safe
+   * border depends on the data, so the estimate assumes the widest
+   * border valueRange (maximum - minimum of the input) can need. The
+   * default of 0 uses ValueRange if set, else the range of the pixel
+   * type, which is unbounded for floating point pixels: pass the range
+   * of the data for those, or the border isn't counted.
+   */
+  ParabolicCostEstimate
+  EstimateCost(const SizeType & size, const SpacingType & spacing, double valueRange = 0) const;
+
   /** ParabolicOpenCloseImageFilter must forward the Modified() call to its
     internal filters */
   void
@@ -150,18 +188,18 @@ protected:
   PrintSelf(std::ostream & os, Indent indent) const override;
 
   using MorphFilterType = ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>;
-  using PadFilterType = ConstantPadImageFilter<TInputImage, TInputImage>;
   using CropFilterType = CropImageFilter<TOutputImage, TOutputImage>;
-  using StatsFilterType = StatisticsImageFilter<InputImageType>;
 
   ParabolicOpenCloseSafeBorderImageFilter()
   {
     m_MorphFilt = MorphFilterType::New();
-    m_PadFilt = PadFilterType::New();
     m_CropFilt = CropFilterType::New();
-    m_StatsFilt = StatsFilterType::New();
+    // the padded result is only needed until it has been cropped
+    m_MorphFilt->ReleaseDataFlagOn();
     m_SafeBorder = true;
     m_ParabolicAlgorithm = INTERSECTION;
+    m_BorderPadLowerBoundUsed.Fill(0);
+    m_BorderPadUpperBoundUsed.Fill(0);
   }
 
   ~ParabolicOpenCloseSafeBorderImageFilter() override = default;
@@ -169,13 +207,13 @@ protected:
 
 private:
   typename MorphFilterType::Pointer m_MorphFilt;
-  typename PadFilterType::Pointer   m_PadFilt;
   typename CropFilterType::Pointer  m_CropFilt;
-  typename StatsFilterType::Pointer m_StatsFilt;
 
-  bool m_SafeBorder;
-  bool m_UseContactPoint;
-  bool m_UseIntersection;
+  bool     m_SafeBorder;
+  SizeType m_BorderPadLowerBoundUsed;
+  SizeType m_BorderPadUpperBoundUsed;
+  bool     m_UseContactPoint;
+  bool     m_UseIntersection;
 };
 } // end namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
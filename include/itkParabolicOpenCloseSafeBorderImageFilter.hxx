@@ -18,7 +18,9 @@
 #ifndef itkParabolicOpenCloseSafeBorderImageFilter_hxx
 #define itkParabolicOpenCloseSafeBorderImageFilter_hxx
 
+#include <algorithm>
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
@@ -32,73 +34,83 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::Gene
 
   // Allocate the output
   this->AllocateOutputs();
-  InputImageConstPointer           inputImage;
-  typename PadFilterType::SizeType Bounds;
-  typename PadFilterType::SizeType BoundsSize;
+  auto localInput = TInputImage::New();
+  localInput->Graft(this->GetInput());
+
+  typename TInputImage::SizeType LowerBounds;
+  typename TInputImage::SizeType UpperBounds;
+  LowerBounds.Fill(0);
+  UpperBounds.Fill(0);
   if (this->m_SafeBorder)
   {
-    auto localInput = TInputImage::New();
-    localInput->Graft(this->GetInput());
-
-    // need to compute some image statistics and determine the padding
-    // extent. This will almost certainly be an over estimate
-    m_StatsFilt->SetInput(localInput);
-    m_StatsFilt->Update();
-    InputPixelType                       range = m_StatsFilt->GetMaximum() - m_StatsFilt->GetMinimum();
+    // The border is the maximum for an opening, the minimum for a
+    // closing, and needs to be wide enough that the second stage
+    // can't see past it. sqrt(2 * scale * range) always is, but
+    // the range that matters on each side is only between the border
+    // value and the values in a band sqrt(2) times that wide along
+    // the side. Farther pixels are too far away to compete with the
+    // border. One pass over the input gives the extremes of every
+    // slice, and so both ranges.
+    using ProfileType = std::array<std::vector<InputPixelType>, ImageDimension>;
+    ProfileType minima;
+    ProfileType maxima;
+    const typename TInputImage::RegionType region = localInput->GetBufferedRegion();
+    ParabolicSliceExtrema(localInput.GetPointer(), region, minima, maxima);
+
+    const InputPixelType minimum = *std::min_element(minima[0].begin(), minima[0].end());
+    const InputPixelType maximum = *std::max_element(maxima[0].begin(), maxima[0].end());
+    const InputPixelType borderValue = DoOpen ? maximum : minimum;
+    const double         range = static_cast<double>(maximum) - static_cast<double>(minimum);
+
     typename MorphFilterType::RadiusType Sigma = m_MorphFilt->GetScale();
     typename TInputImage::SpacingType    spcing = localInput->GetSpacing();
     for (unsigned s = 0; s < ImageDimension; s++)
     {
+      double sigma = Sigma[s];
       if (m_MorphFilt->GetUseImageSpacing())
       {
-        RealType image_scale = spcing[s];
-        Bounds[s] = (unsigned long)ceil(sqrt(2 * (Sigma[s] / (image_scale * image_scale)) * range));
-        BoundsSize[s] = Bounds[s];
-      }
-      else
-      {
-        Bounds[s] = (unsigned long)ceil(sqrt(2 * Sigma[s] * range));
-        BoundsSize[s] = Bounds[s];
+        sigma /= spcing[s] * spcing[s];
       }
-    }
-    m_PadFilt->SetPadLowerBound(Bounds);
-    m_PadFilt->SetPadUpperBound(Bounds);
+      const auto          width = static_cast<SizeValueType>(std::ceil(std::sqrt(2 * sigma * range)));
+      const SizeValueType length = region.GetSize(s);
+      const SizeValueType band =
+        std::min(length, std::max<SizeValueType>(1, static_cast<SizeValueType>(std::ceil(std::sqrt(2.0) * width))));
 
-    // need to select between opening and closing here
-    if (DoOpen)
-    {
-      // m_PadFilt->SetConstant(NumericTraits<InputPixelType>::max());
-      m_PadFilt->SetConstant(m_StatsFilt->GetMaximum());
-    }
-    else
-    {
-      // m_PadFilt->SetConstant(NumericTraits<InputPixelType>::NonpositiveMin());
-      m_PadFilt->SetConstant(m_StatsFilt->GetMinimum());
+      // range between the border value and the value in a band
+      // farthest from it
+      const auto & profile = DoOpen ? minima[s] : maxima[s];
+      const auto   bandRange = [borderValue](const auto first, const auto last) {
+        const InputPixelType v = DoOpen ? *std::min_element(first, last) : *std::max_element(first, last);
+        return std::abs(static_cast<double>(borderValue) - static_cast<double>(v));
+      };
+      const double lowerRange = bandRange(profile.begin(), profile.begin() + band);
+      const double upperRange = bandRange(profile.end() - band, profile.end());
+      LowerBounds[s] = static_cast<SizeValueType>(std::ceil(std::sqrt(2 * sigma * lowerRange)));
+      UpperBounds[s] = static_cast<SizeValueType>(std::ceil(std::sqrt(2 * sigma * upperRange)));
     }
-    m_PadFilt->SetInput(localInput);
-    progress->RegisterInternalFilter(m_PadFilt, 0.1f);
-    inputImage = m_PadFilt->GetOutput();
-  }
-  else
-  {
-    auto localInput = TInputImage::New();
-    localInput->Graft(this->GetInput());
-
-    inputImage = localInput;
+    // the border is added inside the first pass of the morphology
+    // filter, rather than by padding the input first
+    m_MorphFilt->SetBorderValue(borderValue);
   }
+  m_MorphFilt->SetBorderPadLowerBound(LowerBounds);
+  m_MorphFilt->SetBorderPadUpperBound(UpperBounds);
+  m_BorderPadLowerBoundUsed = LowerBounds;
+  m_BorderPadUpperBoundUsed = UpperBounds;
 
-  m_MorphFilt->SetInput(inputImage);
+  m_MorphFilt->SetInput(localInput);
   m_MorphFilt->SetParabolicAlgorithm(m_ParabolicAlgorithm);
 
   progress->RegisterInternalFilter(m_MorphFilt, 0.8f);
+  ParabolicShareThreadBudget(this, m_MorphFilt);
 
   if (this->m_SafeBorder)
   {
     // crop
     m_CropFilt->SetInput(m_MorphFilt->GetOutput());
-    m_CropFilt->SetUpperBoundaryCropSize(BoundsSize);
-    m_CropFilt->SetLowerBoundaryCropSize(BoundsSize);
+    m_CropFilt->SetUpperBoundaryCropSize(UpperBounds);
+    m_CropFilt->SetLowerBoundaryCropSize(LowerBounds);
     progress->RegisterInternalFilter(m_CropFilt, 0.1f);
+    ParabolicShareThreadBudget(this, m_CropFilt);
     m_CropFilt->GraftOutput(this->GetOutput());
     m_CropFilt->Update();
     this->GraftOutput(m_CropFilt->GetOutput());
@@ -118,18 +130,73 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::Modi
 {
   Superclass::Modified();
   m_MorphFilt->Modified();
-  m_PadFilt->Modified();
   m_CropFilt->Modified();
-  m_StatsFilt->Modified();
 }
 
 ///////////////////////////////////
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+ParabolicCostEstimate
+ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::EstimateCost(
+  const SizeType &    size,
+  const SpacingType & spacing,
+  double              valueRange) const
+{
+  if (valueRange <= 0)
+  {
+    valueRange = this->GetValueRange();
+  }
+  if (valueRange <= 0)
+  {
+    valueRange = ParabolicPixelTypeRange<InputPixelType>();
+  }
+
+  // a stand in for m_MorphFilt with the border GenerateData would give
+  // it in the worst case
+  auto morph = MorphFilterType::New();
+  morph->SetScale(this->GetScale());
+  morph->SetUseImageSpacing(this->GetUseImageSpacing());
+  morph->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+  morph->SetValueRange(valueRange);
+  morph->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  if (!m_SafeBorder)
+  {
+    return morph->EstimateCost(size, spacing);
+  }
+
+  ParabolicCostEstimate cost;
+  SizeType              border;
+  const auto &          scale = this->GetScale();
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    double sigma = scale[d];
+    if (this->GetUseImageSpacing())
+    {
+      sigma /= spacing[d] * spacing[d];
+    }
+    border[d] = static_cast<SizeValueType>(std::ceil(std::sqrt(2 * sigma * valueRange)));
+    // the profiles of slice extremes
+    cost.PeakBytes += 2 * size[d] * sizeof(InputPixelType);
+  }
+  morph->SetBorderPad(border);
+
+  // the profile pass and the crop each visit every pixel once
+  cost.Operations = 2 * static_cast<double>(typename TInputImage::RegionType(size).GetNumberOfPixels());
+  cost += morph->EstimateCost(size, spacing);
+  // the cropped copy is the output
+  cost.PeakBytes += ParabolicImageBytes<OutputPixelType>(size);
+  return cost;
+}
+
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
 void
 ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::PrintSelf(std::ostream & os,
                                                                                       Indent         indent) const
 {
   os << indent << "SafeBorder: " << m_SafeBorder << std::endl;
+  os << indent << "BorderPadLowerBoundUsed: " << m_BorderPadLowerBoundUsed << std::endl;
+  os << indent << "BorderPadUpperBoundUsed: " << m_BorderPadUpperBoundUsed << std::endl;
+  os << indent << "ValueRange: " << this->GetValueRange() << std::endl;
   if (this->GetUseImageSpacing())
   {
     os << "Scale in world units: " << this->GetScale() << std::endl;
@@ -0,0 +1,82 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicUpdateAsync_h
+#define itkParabolicUpdateAsync_h
+
+#include <exception>
+#include <functional>
+#include <future>
+#include "itkProcessObject.h"
+
+namespace itk
+{
+/**
+ * Start updating a filter (usually the last filter of a pipeline)
+ * without blocking the caller, for example to overlap reading the next
+ * volume with a distance transform of the current one.
+ *
+ * A single thread is started to drive the update. It does no image
+ * work itself: the passes are run by the filter's MultiThreader, as for
+ * a blocking Update(), so the number of threads doing image work is
+ * still set by the filter's number of work units. With the default
+ * pool based threader, every filter draws on the same ITK thread pool,
+ * so overlapping several updates does not oversubscribe the machine.
+ * The composite filters pass their budget on to their internal filters,
+ * so limiting the work units of each concurrently running filter is
+ * enough to divide the machine between them. Don't give concurrently
+ * running filters the same MultiThreader with SetMultiThreader.
+ *
+ * The returned future becomes ready when the update has finished, and
+ * rethrows from get() any exception thrown by the update. If a callback
+ * is given it is called from the driving thread when the update ends,
+ * with a null exception_ptr on success or the exception on failure,
+ * before the future becomes ready.
+ *
+ * The filter is kept alive until the update finishes. It, its inputs
+ * and the rest of its pipeline must not be modified or updated from
+ * another thread in the meantime.
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename TFilter>
+std::future<void>
+ParabolicUpdateAsync(TFilter * filter, std::function<void(std::exception_ptr)> onComplete = nullptr)
+{
+  typename TFilter::Pointer keepAlive(filter);
+  return std::async(std::launch::async, [keepAlive, onComplete]() {
+    try
+    {
+      keepAlive->Update();
+    }
+    catch (...)
+    {
+      if (onComplete)
+      {
+        onComplete(std::current_exception());
+      }
+      throw;
+    }
+    if (onComplete)
+    {
+      onComplete(nullptr);
+    }
+  });
+}
+} // end namespace itk
+
+#endif
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <atomic>
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicUpdateAsync.h"
+
+// run an erosion without blocking, then check the callback and the
+// result. A second update, with an invalid axis order, must report its
+// exception through both the callback and the future.
+
+int
+itkParaAsyncTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetUseImageSpacing(true);
+  filter->SetScale(1.0);
+
+  std::atomic<int>  succeeded(0);
+  std::atomic<int>  failed(0);
+  auto              onComplete = [&](std::exception_ptr e) { ++(e ? failed : succeeded); };
+  std::future<void> done = itk::ParabolicUpdateAsync(filter.GetPointer(), onComplete);
+  try
+  {
+    done.get();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (succeeded != 1 || failed != 0)
+  {
+    std::cerr << "Completion callback not called once on success" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // fails only on the axis order
+  FilterType::Pointer bad = FilterType::New();
+  bad->SetInput(reader->GetOutput());
+  bad->SetUseImageSpacing(true);
+  bad->SetScale(1.0);
+  FilterType::AxisOrderType order;
+  order.Fill(0);
+  bad->SetAxisOrder(order);
+  bool caught = false;
+  try
+  {
+    itk::ParabolicUpdateAsync(bad.GetPointer(), onComplete).get();
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught || failed != 1)
+  {
+    std::cerr << "Exception not propagated from the asynchronous update" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicErodeBatchImageFilter.h"
+#include "itkMultiThreaderBase.h"
+
+// check that the batch filter matches the single image filter, for
+// inputs of different sizes
+
+int
+itkParaBatchTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // the whole image followed by some patches of different sizes
+  std::vector<IType::Pointer> inputs;
+  inputs.push_back(reader->GetOutput());
+
+  const IType::SizeType fullSize = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+  for (unsigned int p = 1; p < 8; ++p)
+  {
+    using ROIType = itk::RegionOfInterestImageFilter<IType, IType>;
+    ROIType::Pointer     roi = ROIType::New();
+    IType::RegionType    region = reader->GetOutput()->GetLargestPossibleRegion();
+    IType::SizeType      size;
+    IType::IndexType     index = region.GetIndex();
+    for (unsigned int d = 0; d < dim; ++d)
+    {
+      size[d] = fullSize[d] / (p + 1) + d;
+      index[d] += p * (fullSize[d] - size[d]) / 8;
+    }
+    region.SetIndex(index);
+    region.SetSize(size);
+    roi->SetInput(reader->GetOutput());
+    roi->SetRegionOfInterest(region);
+    roi->Update();
+    inputs.push_back(roi->GetOutput());
+  }
+
+  using BatchType = itk::ParabolicErodeBatchImageFilter<IType, IType>;
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+
+  BatchType::Pointer batch = BatchType::New();
+  batch->SetScale(1.0);
+  batch->SetUseImageSpacing(true);
+  batch->SetParabolicAlgorithm(BatchType::INTERSECTION);
+  batch->SetNumberOfWorkUnits(3);
+  for (unsigned int i = 0; i < inputs.size(); ++i)
+  {
+    batch->SetInput(i, inputs[i]);
+  }
+
+  try
+  {
+    batch->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetScale(1.0);
+  filter->SetUseImageSpacing(true);
+  filter->SetParabolicAlgorithm(FilterType::INTERSECTION);
+
+  for (unsigned int i = 0; i < inputs.size(); ++i)
+  {
+    filter->SetInput(inputs[i]);
+    try
+    {
+      filter->Update();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const IType * batchOut = batch->GetOutput(i);
+    if (batchOut->GetLargestPossibleRegion() != filter->GetOutput()->GetLargestPossibleRegion())
+    {
+      std::cerr << "Region mismatch for input " << i << std::endl;
+      return EXIT_FAILURE;
+    }
+    itk::ImageRegionConstIterator<IType> bIt(batchOut, batchOut->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<IType> fIt(filter->GetOutput(), batchOut->GetLargestPossibleRegion());
+    for (; !bIt.IsAtEnd(); ++bIt, ++fIt)
+    {
+      if (bIt.Get() != fIt.Get())
+      {
+        std::cerr << "Batch output " << i << " differs from single image filter at " << bIt.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(batch->GetOutput(0));
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
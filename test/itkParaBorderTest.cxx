@@ -0,0 +1,178 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCastImageFilter.h"
+#include "itkConstantPadImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicOpenCloseImageFilter.h"
+
+// A virtual border must give the same result as padding the input
+// with a constant first. The erosion pads with the maximum, so the
+// border has no effect inside the image, the opening works on floats
+// and pads with a mid range value that does.
+
+int
+itkParaBorderTest(int argc, char * argv[])
+{
+  if (argc < 6)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage erodeBorder erodePad openBorder openPad" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using CastType = itk::CastImageFilter<IType, FType>;
+  CastType::Pointer cast = CastType::New();
+  cast->SetInput(reader->GetOutput());
+
+  constexpr double scale = 2.0;
+
+  IType::SizeType pad;
+  pad[0] = 12;
+  pad[1] = 7;
+
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, IType>;
+  using OpenType = itk::ParabolicOpenCloseImageFilter<FType, true, FType>;
+  using IPadType = itk::ConstantPadImageFilter<IType, IType>;
+  using FPadType = itk::ConstantPadImageFilter<FType, FType>;
+  using IWriterType = itk::ImageFileWriter<IType>;
+  using FWriterType = itk::ImageFileWriter<FType>;
+
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput(reader->GetOutput());
+  erode->SetUseImageSpacing(true);
+  erode->SetScale(scale);
+  erode->SetBorderPad(pad);
+  erode->SetBorderValue(255);
+
+  IPadType::Pointer ipad = IPadType::New();
+  ipad->SetInput(reader->GetOutput());
+  ipad->SetPadLowerBound(pad);
+  ipad->SetPadUpperBound(pad);
+  ipad->SetConstant(255);
+  ErodeType::Pointer erodePadded = ErodeType::New();
+  erodePadded->SetInput(ipad->GetOutput());
+  erodePadded->SetUseImageSpacing(true);
+  erodePadded->SetScale(scale);
+
+  OpenType::Pointer open = OpenType::New();
+  open->SetInput(cast->GetOutput());
+  open->SetUseImageSpacing(true);
+  open->SetScale(scale);
+  open->SetBorderPad(pad);
+  open->SetBorderValue(100);
+
+  FPadType::Pointer fpad = FPadType::New();
+  fpad->SetInput(cast->GetOutput());
+  fpad->SetPadLowerBound(pad);
+  fpad->SetPadUpperBound(pad);
+  fpad->SetConstant(100);
+  OpenType::Pointer openPadded = OpenType::New();
+  openPadded->SetInput(fpad->GetOutput());
+  openPadded->SetUseImageSpacing(true);
+  openPadded->SetScale(scale);
+
+  IWriterType::Pointer iwriter = IWriterType::New();
+  FWriterType::Pointer fwriter = FWriterType::New();
+  try
+  {
+    iwriter->SetInput(erode->GetOutput());
+    iwriter->SetFileName(argv[2]);
+    iwriter->Update();
+    iwriter->SetInput(erodePadded->GetOutput());
+    iwriter->SetFileName(argv[3]);
+    iwriter->Update();
+    fwriter->SetInput(open->GetOutput());
+    fwriter->SetFileName(argv[4]);
+    fwriter->Update();
+    fwriter->SetInput(openPadded->GetOutput());
+    fwriter->SetFileName(argv[5]);
+    fwriter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // the output covers the padded region
+  if (erode->GetOutput()->GetLargestPossibleRegion() != erodePadded->GetOutput()->GetLargestPossibleRegion() ||
+      open->GetOutput()->GetLargestPossibleRegion() != openPadded->GetOutput()->GetLargestPossibleRegion())
+  {
+    std::cerr << "Bordered output " << erode->GetOutput()->GetLargestPossibleRegion() << " should match "
+              << erodePadded->GetOutput()->GetLargestPossibleRegion() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // asking for in place can't use the smaller input buffer
+  ErodeType::Pointer erodeInPlace = ErodeType::New();
+  erodeInPlace->SetInput(reader->GetOutput());
+  erodeInPlace->SetUseImageSpacing(true);
+  erodeInPlace->SetScale(scale);
+  erodeInPlace->SetBorderPad(pad);
+  erodeInPlace->SetBorderValue(255);
+  erodeInPlace->InPlaceOn();
+  try
+  {
+    erodeInPlace->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (erodeInPlace->GetOutput()->GetBufferedRegion() != erode->GetOutput()->GetBufferedRegion() ||
+      reader->GetOutput()->GetBufferedRegion().GetNumberOfPixels() == 0 ||
+      reader->GetOutput()->GetBufferPointer() == erodeInPlace->GetOutput()->GetBufferPointer())
+  {
+    std::cerr << "In place with a border used the input buffer" << std::endl;
+    return EXIT_FAILURE;
+  }
+  itk::ImageRegionConstIteratorWithIndex<IType> it(erode->GetOutput(), erode->GetOutput()->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    if (erodeInPlace->GetOutput()->GetPixel(it.GetIndex()) != it.Get())
+    {
+      std::cerr << "In place with a border differs at " << it.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
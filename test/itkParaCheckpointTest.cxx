@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <fstream>
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "itkParabolicErodeImageFilter.h"
+
+// Abort an erosion after its first pass, as a preemption would, then
+// resume it in a new filter from the checkpoint. Only the second pass
+// should run, and the result should match an uninterrupted erosion.
+// A masked erosion must not resume with a different mask.
+
+int
+itkParaCheckpointTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage checkpointFile" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  auto makeFilter = [&]() {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(reader->GetOutput());
+    filter->SetUseImageSpacing(true);
+    filter->SetScale(1.0);
+    filter->SetCheckpointFileName(argv[3]);
+    // in the calling thread, so the abort reaches this function
+    filter->SetNumberOfWorkUnits(1);
+    return filter;
+  };
+
+  // abort once the second pass has started, so the first one has been
+  // checkpointed
+  FilterType::Pointer interrupted = makeFilter();
+  FilterType *        raw = interrupted.GetPointer();
+  interrupted->AddObserver(itk::ProgressEvent(), [raw](const itk::EventObject &) {
+    if (raw->GetCurrentPass() >= 1)
+    {
+      raw->AbortGenerateDataOn();
+    }
+  });
+  bool aborted = false;
+  try
+  {
+    interrupted->Update();
+  }
+  catch (itk::ProcessAborted &)
+  {
+    aborted = true;
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (!aborted || !std::ifstream(argv[3]))
+  {
+    std::cerr << "No checkpoint left by the interrupted erosion" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FilterType::Pointer resumed = makeFilter();
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(resumed->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (resumed->GetNumberOfResumedPasses() != 1)
+  {
+    std::cerr << "Resumed " << resumed->GetNumberOfResumedPasses() << " passes, expected 1" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (std::ifstream(argv[3]))
+  {
+    std::cerr << "Checkpoint not removed after the last pass" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // a masked erosion resumes only with the mask it was interrupted with
+  using MaskType = FilterType::MaskImageType;
+  auto makeMask = [&reader](const itk::IndexValueType split, const bool below) {
+    MaskType::Pointer mask = MaskType::New();
+    mask->CopyInformation(reader->GetOutput());
+    mask->SetRegions(reader->GetOutput()->GetLargestPossibleRegion());
+    mask->Allocate();
+    for (itk::ImageRegionIteratorWithIndex<MaskType> it(mask, mask->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+      it.Set((it.GetIndex()[0] < split) == below ? 1 : 0);
+    }
+    return mask;
+  };
+  const MaskType::Pointer left = makeMask(128, true);
+  const MaskType::Pointer right = makeMask(64, false);
+  for (const MaskType * resumeMask : { right.GetPointer(), left.GetPointer() })
+  {
+    FilterType::Pointer maskedInterrupted = makeFilter();
+    maskedInterrupted->SetMaskImage(left);
+    FilterType * maskedRaw = maskedInterrupted.GetPointer();
+    maskedInterrupted->AddObserver(itk::ProgressEvent(), [maskedRaw](const itk::EventObject &) {
+      if (maskedRaw->GetCurrentPass() >= 1)
+      {
+        maskedRaw->AbortGenerateDataOn();
+      }
+    });
+    try
+    {
+      maskedInterrupted->Update();
+    }
+    catch (itk::ProcessAborted &)
+    {
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    FilterType::Pointer maskedResumed = makeFilter();
+    maskedResumed->SetMaskImage(resumeMask);
+    try
+    {
+      maskedResumed->Update();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+    }
+    const unsigned int expected = resumeMask == left.GetPointer() ? 1 : 0;
+    if (maskedResumed->GetNumberOfResumedPasses() != expected)
+    {
+      std::cerr << "Masked erosion resumed " << maskedResumed->GetNumberOfResumedPasses() << " passes, expected "
+                << expected << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include <itkBinaryThresholdImageFilter.h>
+
+#include "itkBinaryErodeParaImageFilter.h"
+#include "itkBinaryDilateParaImageFilter.h"
+#include "itkBinaryOpenParaImageFilter.h"
+#include "itkBinaryCloseParaImageFilter.h"
+
+// The binary filters with 16-bit fixed point intermediates give the
+// same results as with float ones at this radius, and need less memory.
+
+int
+itkParaCompactTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  bool ok = true;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const IType::SizeType    size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+  const IType::SpacingType spacing = reader->GetOutput()->GetSpacing();
+
+  // the same masks as the binary tests
+  auto mask = [&reader](const int threshold) {
+    using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+    ThreshType::Pointer thresh = ThreshType::New();
+    thresh->SetInput(reader->GetOutput());
+    thresh->SetUpperThreshold(threshold);
+    thresh->SetInsideValue(0);
+    thresh->SetOutsideValue(1);
+    thresh->Update();
+    IType::Pointer result = thresh->GetOutput();
+    result->DisconnectPipeline();
+    return result;
+  };
+
+  // run a filter with float and with compact intermediates, and count
+  // the pixels that differ
+  auto compare = [&](auto filter, const int threshold, const char * name) {
+    filter->SetInput(mask(threshold));
+    filter->SetUseImageSpacing(true);
+    filter->SetRadius(10);
+    filter->Update();
+    IType::Pointer reference = filter->GetOutput();
+    reference->DisconnectPipeline();
+    const itk::SizeValueType floatBytes = filter->EstimateCost(size, spacing).PeakBytes;
+
+    filter->CompactIntermediatesOn();
+    filter->Update();
+    const itk::SizeValueType compactBytes = filter->EstimateCost(size, spacing).PeakBytes;
+
+    itk::ImageRegionConstIterator<IType> refIt(reference, reference->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<IType> it(filter->GetOutput(), reference->GetLargestPossibleRegion());
+    unsigned long                        differences = 0;
+    for (; !it.IsAtEnd(); ++it, ++refIt)
+    {
+      differences += (it.Get() != refIt.Get());
+    }
+    std::cout << name << ": " << differences << " pixels differ, " << compactBytes << " bytes rather than "
+              << floatBytes << std::endl;
+    if (differences != 0)
+    {
+      std::cerr << "Failed: " << name << " differs from the float result" << std::endl;
+      ok = false;
+    }
+    if (compactBytes >= floatBytes)
+    {
+      std::cerr << "Failed: " << name << " uses no less memory" << std::endl;
+      ok = false;
+    }
+  };
+
+  compare(itk::BinaryErodeParaImageFilter<IType, IType>::New(), 120, "erode");
+  compare(itk::BinaryDilateParaImageFilter<IType, IType>::New(), 150, "dilate");
+  compare(itk::BinaryOpenParaImageFilter<IType, IType>::New(), 130, "open");
+
+  using CloseType = itk::BinaryCloseParaImageFilter<IType, IType>;
+  CloseType::Pointer close = CloseType::New();
+  compare(close, 150, "close");
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(close->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicOpenCloseSafeBorderImageFilter.h"
+#include "itkBinaryOpenParaImageFilter.h"
+#include "itkMorphologicalDistanceTransformImageFilter.h"
+#include "itkMorphologicalSignedDistanceTransformImageFilter.h"
+
+// Check that the cost estimates cover what an update allocates and
+// move the right way as the settings change.
+
+int
+itkParaCostTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  bool ok = true;
+  auto check = [&ok](const bool condition, const char * what) {
+    if (!condition)
+    {
+      std::cerr << "Failed: " << what << std::endl;
+      ok = false;
+    }
+  };
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->UpdateOutputInformation();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const IType::SizeType    size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+  const IType::SpacingType spacing = reader->GetOutput()->GetSpacing();
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetUseImageSpacing(true);
+  filter->SetScale(1.0);
+
+  const itk::ParabolicCostEstimate cost = filter->EstimateCost(size, spacing);
+  std::cout << "Erode: " << cost.PeakBytes << " bytes, " << cost.Operations << " operations" << std::endl;
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const itk::SizeValueType outputBytes = filter->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(PType);
+  check(cost.PeakBytes >= outputBytes, "output buffer counted");
+  check(cost.Operations >= 2.0 * size[0] * size[1], "one step per pixel per pass");
+
+  // running in place, or into a caller's buffer, saves the output
+  filter->InPlaceOn();
+  check(filter->EstimateCost(size, spacing).PeakBytes + outputBytes == cost.PeakBytes, "in place saves the output");
+  filter->InPlaceOff();
+  filter->SetOutputPixelContainer(IType::PixelContainer::New());
+  check(filter->EstimateCost(size, spacing).PeakBytes + outputBytes == cost.PeakBytes,
+        "caller container saves the output");
+  filter->SetOutputPixelContainer(nullptr);
+
+  // the cache keeps the first of the two passes
+  filter->UseIntermediateCacheOn();
+  check(filter->EstimateCost(size, spacing).PeakBytes == cost.PeakBytes + outputBytes, "cache holds one pass");
+
+  // a mask turns the cache off and needs the positions of each line
+  FilterType::MaskImageType::Pointer mask = FilterType::MaskImageType::New();
+  mask->SetRegions(reader->GetOutput()->GetLargestPossibleRegion());
+  filter->SetMaskImage(mask);
+  const itk::ParabolicCostEstimate masked = filter->EstimateCost(size, spacing);
+  check(masked.PeakBytes > cost.PeakBytes && masked.PeakBytes < cost.PeakBytes + outputBytes, "mask keeps no cache");
+  check(masked.Operations == cost.Operations, "mask charged as if all inside");
+  filter->SetMaskImage(nullptr);
+  filter->UseIntermediateCacheOff();
+
+  // a direction with no scale is skipped
+  FilterType::RadiusType scale;
+  scale[0] = 1.0;
+  scale[1] = 0.0;
+  filter->SetScale(scale);
+  check(2 * filter->EstimateCost(size, spacing).Operations == cost.Operations, "zero scale skips a pass");
+
+  // the safe border makes a bigger image than the plain closing
+  using SafeType = itk::ParabolicOpenCloseSafeBorderImageFilter<FType, false, FType>;
+  using CloseType = itk::ParabolicOpenCloseImageFilter<FType, false, FType>;
+  SafeType::Pointer  safe = SafeType::New();
+  CloseType::Pointer close = CloseType::New();
+  safe->SetScale(5.0);
+  close->SetScale(5.0);
+  check(safe->EstimateCost(size, spacing, 255).PeakBytes > close->EstimateCost(size, spacing).PeakBytes,
+        "safe border is larger");
+  safe->SafeBorderOff();
+  check(safe->EstimateCost(size, spacing, 255).PeakBytes == close->EstimateCost(size, spacing).PeakBytes,
+        "no safe border matches the closing");
+
+  using BinaryOpenType = itk::BinaryOpenParaImageFilter<IType, IType>;
+  BinaryOpenType::Pointer binaryOpen = BinaryOpenType::New();
+  binaryOpen->SetRadius(10);
+  binaryOpen->SafeBorderOn();
+  const itk::SizeValueType withBorder = binaryOpen->EstimateCost(size, spacing).PeakBytes;
+  binaryOpen->SafeBorderOff();
+  check(withBorder > binaryOpen->EstimateCost(size, spacing).PeakBytes, "binary safe border is larger");
+
+  // the signed transform needs an erosion, a dilation and a helper
+  // image more than the unsigned one
+  using DTType = itk::MorphologicalDistanceTransformImageFilter<IType, FType>;
+  using SDTType = itk::MorphologicalSignedDistanceTransformImageFilter<IType, FType>;
+  DTType::Pointer  dt = DTType::New();
+  SDTType::Pointer sdt = SDTType::New();
+  check(sdt->EstimateCost(size, spacing).PeakBytes > dt->EstimateCost(size, spacing).PeakBytes,
+        "signed transform is larger");
+
+  // but the output reuses the erosion, so it only ever holds two
+  // images
+  sdt->SetNumberOfWorkUnits(1);
+  const itk::SizeValueType floatBytes = size[0] * size[1] * sizeof(float);
+  check(sdt->EstimateCost(size, spacing).PeakBytes < 3 * floatBytes, "signed transform holds two images");
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,113 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+#include "itkParabolicEngine.h"
+
+// call the engine from several threads at once, each with its own
+// output. Every output should match the erosion filter.
+
+int
+itkParaEngineTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const IType * input = reader->GetOutput();
+
+  using EngineType = itk::ParabolicEngine<IType, IType>;
+  EngineType::Parameters parameters;
+  parameters.Scale.Fill(1.0);
+  parameters.UseImageSpacing = true;
+  parameters.ParabolicAlgorithm = EngineType::INTERSECTION;
+
+  constexpr unsigned int      numberOfRequests = 8;
+  std::vector<IType::Pointer> outputs;
+  for (unsigned int i = 0; i < numberOfRequests; ++i)
+  {
+    outputs.push_back(IType::New());
+  }
+
+  std::vector<std::thread> requests;
+  for (unsigned int i = 0; i < numberOfRequests; ++i)
+  {
+    requests.emplace_back([&, i]() {
+      // repeat, so that the thread's line buffers are reused
+      for (unsigned int r = 0; r < 3; ++r)
+      {
+        EngineType::Erode(*input, *outputs[i], parameters);
+      }
+    });
+  }
+  for (auto & request : requests)
+  {
+    request.join();
+  }
+
+  const size_t numberOfPixels = input->GetBufferedRegion().GetNumberOfPixels();
+  for (unsigned int i = 1; i < numberOfRequests; ++i)
+  {
+    if (!std::equal(outputs[0]->GetBufferPointer(),
+                    outputs[0]->GetBufferPointer() + numberOfPixels,
+                    outputs[i]->GetBufferPointer()))
+    {
+      std::cerr << "Request " << i << " differs from request 0" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(outputs[0]);
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <vector>
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+
+#include "itkParabolicLineScanStream.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+#include "itkParabolicOpenCloseImageFilter.h"
+
+// Feed an image to the line scan stream one row at a time, check that
+// each row is finished as soon as the latency allows, and compare the
+// rows with the filters applied to the whole image.
+
+int
+itkParaLineScanTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = float;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using StreamType = itk::ParabolicLineScanStream<PType>;
+  StreamType::RadiusType scale;
+  scale[0] = 2.0;
+  scale[1] = 3.0;
+
+  // the whole image results to compare with
+  std::vector<IType::Pointer> exact;
+  auto                        runExact = [&](auto filter) {
+    filter->SetInput(reader->GetOutput());
+    filter->SetScale(scale);
+    filter->Update();
+    exact.push_back(filter->GetOutput());
+  };
+  try
+  {
+    runExact(itk::ParabolicErodeImageFilter<IType, IType>::New());
+    runExact(itk::ParabolicDilateImageFilter<IType, IType>::New());
+    runExact(itk::ParabolicOpenCloseImageFilter<IType, true, IType>::New());
+    runExact(itk::ParabolicOpenCloseImageFilter<IType, false, IType>::New());
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const IType *            input = reader->GetOutput();
+  const IType::SizeType    size = input->GetLargestPossibleRegion().GetSize();
+  const itk::SizeValueType width = size[0];
+  const itk::SizeValueType height = size[1];
+  StreamType               stream;
+  StreamType::Parameters   parameters;
+  std::vector<PType>       row(width);
+  parameters.Scale = scale;
+  parameters.ValueRange = 255;
+
+  for (int operation = StreamType::ERODE; operation <= StreamType::CLOSE; ++operation)
+  {
+    parameters.Operation = operation;
+    stream.Start(width, parameters);
+    const itk::SizeValueType latency = stream.GetLatency();
+
+    itk::SizeValueType popped = 0;
+    double             worst = 0;
+    auto               popFinished = [&]() {
+      while (stream.PopRow(row.data()))
+      {
+        for (itk::SizeValueType x = 0; x < width; ++x)
+        {
+          IType::IndexType index = { { static_cast<itk::IndexValueType>(x),
+                                       static_cast<itk::IndexValueType>(popped) } };
+          worst = std::max(worst, std::abs(static_cast<double>(row[x]) - exact[operation]->GetPixel(index)));
+        }
+        ++popped;
+      }
+    };
+
+    for (itk::SizeValueType y = 0; y < height; ++y)
+    {
+      IType::IndexType index = { { 0, static_cast<itk::IndexValueType>(y) } };
+      stream.PushRow(&input->GetPixel(index));
+      popFinished();
+      const itk::SizeValueType expected = y + 1 > latency ? y + 1 - latency : 0;
+      if (popped != expected)
+      {
+        std::cerr << "Operation " << operation << ": " << popped << " rows finished after " << y + 1
+                  << " pushed, expected " << expected << " with latency " << latency << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    stream.Finish();
+    popFinished();
+
+    std::cout << "Operation " << operation << " latency " << latency << " error " << worst << std::endl;
+    if (popped != height || worst > 1e-3)
+    {
+      std::cerr << "Operation " << operation << ": " << popped << " of " << height << " rows, error " << worst
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <fstream>
+#include <iomanip>
+#include "itkImageFileReader.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicMappedImageContainer.h"
+
+// Erode straight into a memory mapped raw file, described by a
+// MetaImage header written beforehand, with no writer involved.
+
+int
+itkParaMappedTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputHeader.mhd outputData.raw" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->UpdateOutputInformation();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const IType *         input = reader->GetOutput();
+  const IType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+
+  // the data file is named relative to the header, so both are
+  // expected in the same directory
+  std::ofstream header(argv[2]);
+  header << "ObjectType = Image\n"
+         << "NDims = " << dim << "\n"
+         << "DimSize = " << size[0] << " " << size[1] << "\n"
+         << "ElementSpacing = " << input->GetSpacing()[0] << " " << input->GetSpacing()[1] << "\n"
+         << "Offset = " << input->GetOrigin()[0] << " " << input->GetOrigin()[1] << "\n"
+         << "BinaryData = True\n"
+         << "ElementType = MET_UCHAR\n"
+         << "ElementDataFile = " << argv[3] << "\n";
+  header.close();
+  if (!header)
+  {
+    std::cerr << "Cannot write " << argv[2] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ContainerType = itk::ParabolicMappedImageContainer<itk::SizeValueType, PType>;
+  ContainerType::Pointer container = ContainerType::New();
+  try
+  {
+    container->MapFile(argv[3], input->GetLargestPossibleRegion().GetNumberOfPixels());
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetUseImageSpacing(true);
+  filter->SetScale(1.0);
+  filter->SetOutputPixelContainer(container);
+  try
+  {
+    filter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (filter->GetOutput()->GetBufferPointer() != container->GetBufferPointer())
+  {
+    std::cerr << "Output was not written to the mapped file" << std::endl;
+    return EXIT_FAILURE;
+  }
+  container->Flush();
+
+  return EXIT_SUCCESS;
+}
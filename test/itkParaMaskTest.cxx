@@ -0,0 +1,187 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <type_traits>
+#include <vector>
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+
+// Erode and dilate inside a mask with holes and with lines wholly
+// outside it, out of place and in place, and compare with a direct
+// evaluation of each pass over the samples inside the mask. Outside
+// the mask the input must come through unchanged.
+
+namespace
+{
+using PType = float;
+using IType = itk::Image<PType, 2>;
+using MType = itk::Image<unsigned char, 2>;
+
+// each pass in turn, over the samples of each line inside the mask
+IType::Pointer
+MaskedReference(const IType * input, const MType * mask, const double scale, const bool dilate)
+{
+  IType::Pointer result = IType::New();
+  result->CopyInformation(input);
+  result->SetRegions(input->GetLargestPossibleRegion());
+  result->Allocate();
+  std::copy_n(input->GetBufferPointer(),
+              input->GetLargestPossibleRegion().GetNumberOfPixels(),
+              result->GetBufferPointer());
+
+  const IType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+  const double          magnitude = 1.0 / (2.0 * scale);
+  for (unsigned int d = 0; d < 2; ++d)
+  {
+    const unsigned int other = 1 - d;
+    for (itk::SizeValueType line = 0; line < size[other]; ++line)
+    {
+      IType::IndexType index;
+      index[other] = static_cast<itk::IndexValueType>(line);
+      std::vector<itk::IndexValueType> inside;
+      std::vector<double>              values;
+      for (itk::SizeValueType i = 0; i < size[d]; ++i)
+      {
+        index[d] = static_cast<itk::IndexValueType>(i);
+        if (mask->GetPixel(index))
+        {
+          inside.push_back(index[d]);
+          values.push_back(result->GetPixel(index));
+        }
+      }
+      for (const itk::IndexValueType i : inside)
+      {
+        double best = dilate ? -1e30 : 1e30;
+        for (size_t j = 0; j < inside.size(); ++j)
+        {
+          const double offset = static_cast<double>(i - inside[j]);
+          best = dilate ? std::max(best, values[j] - magnitude * offset * offset)
+                        : std::min(best, values[j] + magnitude * offset * offset);
+        }
+        index[d] = i;
+        result->SetPixel(index, static_cast<PType>(best));
+      }
+    }
+  }
+  return result;
+}
+
+template <typename TFilter>
+int
+CheckMasked(const IType * input, const MType * mask, const double scale, const bool inPlace)
+{
+  constexpr bool dilate = std::is_same<TFilter, itk::ParabolicDilateImageFilter<IType, IType>>::value;
+
+  // in place overwrites the input, so give it a copy
+  IType::Pointer source = IType::New();
+  source->CopyInformation(input);
+  source->SetRegions(input->GetLargestPossibleRegion());
+  source->Allocate();
+  std::copy_n(
+    input->GetBufferPointer(), input->GetLargestPossibleRegion().GetNumberOfPixels(), source->GetBufferPointer());
+
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput(source);
+  filter->SetMaskImage(mask);
+  filter->SetScale(scale);
+  filter->SetInPlace(inPlace);
+  try
+  {
+    filter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const IType::Pointer reference = MaskedReference(input, mask, scale, dilate);
+  double               worst = 0;
+  unsigned int         outsideChanged = 0;
+  for (itk::ImageRegionConstIteratorWithIndex<IType> it(reference, reference->GetLargestPossibleRegion());
+       !it.IsAtEnd();
+       ++it)
+  {
+    const double value = filter->GetOutput()->GetPixel(it.GetIndex());
+    worst = std::max(worst, std::abs(value - it.Get()));
+    outsideChanged += !mask->GetPixel(it.GetIndex()) && value != input->GetPixel(it.GetIndex());
+  }
+  std::cout << (dilate ? "Dilation" : "Erosion") << (inPlace ? " in place" : "") << " error " << worst << std::endl;
+  if (worst > 1e-3 || outsideChanged > 0)
+  {
+    std::cerr << "Masked " << (dilate ? "dilation" : "erosion") << (inPlace ? " in place" : "") << " differs by "
+              << worst << ", " << outsideChanged << " pixels outside the mask changed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+} // namespace
+
+int
+itkParaMaskTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  const IType * input = reader->GetOutput();
+
+  // the brighter pixels of a box: holes inside, and whole rows and
+  // columns outside
+  MType::Pointer mask = MType::New();
+  mask->CopyInformation(input);
+  mask->SetRegions(input->GetLargestPossibleRegion());
+  mask->Allocate();
+  for (itk::ImageRegionIteratorWithIndex<MType> it(mask, mask->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+  {
+    const MType::IndexType index = it.GetIndex();
+    const bool             inBox = index[0] >= 30 && index[0] < 220 && index[1] >= 40 && index[1] < 200;
+    it.Set(inBox && input->GetPixel(index) > 50 ? 1 : 0);
+  }
+
+  constexpr double scale = 5.0;
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, IType>;
+  using DilateType = itk::ParabolicDilateImageFilter<IType, IType>;
+  for (const bool inPlace : { false, true })
+  {
+    if (CheckMasked<ErodeType>(input, mask, scale, inPlace) != EXIT_SUCCESS ||
+        CheckMasked<DilateType>(input, mask, scale, inPlace) != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkCastImageFilter.h"
+#include "itkRegionOfInterestImageFilter.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicOpenCloseImageFilter.h"
+
+// A region of interest downstream of the filters should only cost a
+// margin of the input around it. The filters must buffer exactly the
+// region of interest, and it must match the same region of the whole
+// result. The erosion gets its range from the pixel type, the opening
+// works on floats with a declared range.
+
+namespace
+{
+// the buffered region of roiImage is roi, with the pixels of whole
+template <typename TImage>
+bool
+MatchesWhole(const TImage * roiImage, const TImage * whole, const typename TImage::RegionType & roi)
+{
+  if (roiImage->GetBufferedRegion() != roi)
+  {
+    std::cerr << "Buffered " << roiImage->GetBufferedRegion() << " for a region of interest " << roi << std::endl;
+    return false;
+  }
+  for (itk::ImageRegionConstIteratorWithIndex<TImage> it(roiImage, roi); !it.IsAtEnd(); ++it)
+  {
+    if (itk::Math::NotExactlyEquals(it.Get(), whole->GetPixel(it.GetIndex())))
+    {
+      std::cerr << "Pixel " << it.GetIndex() << " differs from the whole result" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+int
+itkParaROITest(int argc, char * argv[])
+{
+  if (argc < 6)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage erodeROI erodeWhole openROI openWhole" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using CastType = itk::CastImageFilter<IType, FType>;
+  CastType::Pointer cast = CastType::New();
+  cast->SetInput(reader->GetOutput());
+
+  constexpr double scale = 1.0;
+
+  IType::RegionType roi;
+  roi.SetIndex(0, 100);
+  roi.SetIndex(1, 120);
+  roi.SetSize(0, 40);
+  roi.SetSize(1, 30);
+
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, IType>;
+  using OpenType = itk::ParabolicOpenCloseImageFilter<FType, true, FType>;
+  using IROIType = itk::RegionOfInterestImageFilter<IType, IType>;
+  using FROIType = itk::RegionOfInterestImageFilter<FType, FType>;
+  using IWriterType = itk::ImageFileWriter<IType>;
+  using FWriterType = itk::ImageFileWriter<FType>;
+
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput(reader->GetOutput());
+  erode->SetUseImageSpacing(true);
+  erode->SetScale(scale);
+
+  OpenType::Pointer open = OpenType::New();
+  open->SetInput(cast->GetOutput());
+  open->SetUseImageSpacing(true);
+  open->SetScale(scale);
+  open->SetValueRange(255);
+
+  IROIType::Pointer erodeROI = IROIType::New();
+  erodeROI->SetInput(erode->GetOutput());
+  erodeROI->SetRegionOfInterest(roi);
+
+  FROIType::Pointer openROI = FROIType::New();
+  openROI->SetInput(open->GetOutput());
+  openROI->SetRegionOfInterest(roi);
+
+  IWriterType::Pointer iwriter = IWriterType::New();
+  iwriter->SetInput(erodeROI->GetOutput());
+  iwriter->SetFileName(argv[2]);
+  FWriterType::Pointer fwriter = FWriterType::New();
+  fwriter->SetInput(openROI->GetOutput());
+  fwriter->SetFileName(argv[4]);
+  try
+  {
+    iwriter->Update();
+    fwriter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // only a margin of the input around the region of interest should
+  // be requested
+  const IType::RegionType whole = reader->GetOutput()->GetLargestPossibleRegion();
+  if (reader->GetOutput()->GetRequestedRegion().GetNumberOfPixels() >= whole.GetNumberOfPixels() ||
+      cast->GetOutput()->GetRequestedRegion().GetNumberOfPixels() >= whole.GetNumberOfPixels())
+  {
+    std::cerr << "Whole image requested for a region of interest: " << reader->GetOutput()->GetRequestedRegion()
+              << " " << cast->GetOutput()->GetRequestedRegion() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // keep the region of interest results to compare with the whole ones
+  IType::Pointer erodePart = erode->GetOutput();
+  erodePart->DisconnectPipeline();
+  FType::Pointer openPart = open->GetOutput();
+  openPart->DisconnectPipeline();
+
+  // the same regions cut from the whole results
+  try
+  {
+    erode->UpdateLargestPossibleRegion();
+    open->UpdateLargestPossibleRegion();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  IType::Pointer erodeWhole = erode->GetOutput();
+  erodeWhole->DisconnectPipeline();
+  FType::Pointer openWhole = open->GetOutput();
+  openWhole->DisconnectPipeline();
+
+  if (!MatchesWhole<IType>(erodePart, erodeWhole, roi) || !MatchesWhole<FType>(openPart, openWhole, roi))
+  {
+    return EXIT_FAILURE;
+  }
+
+  erodeROI->SetInput(erodeWhole);
+  openROI->SetInput(openWhole);
+  iwriter->SetFileName(argv[3]);
+  fwriter->SetFileName(argv[5]);
+  try
+  {
+    iwriter->Update();
+    fwriter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include <vector>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkBinaryThresholdImageFilter.h"
+
+#include "itkParabolicErodeImageFilter.h"
+
+// apply one filter to a sequence of frames of the same size, as for a
+// time series. The output buffer should be reused, and the result for
+// the last frame should match a filter that only saw that frame.
+
+int
+itkParaRepeatTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage repeatedOutput freshOutput" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  // a second frame with the same geometry
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetLowerThreshold(100);
+  thresh->SetInsideValue(255);
+  thresh->SetOutsideValue(0);
+
+  std::vector<IType::Pointer> frames;
+  try
+  {
+    reader->Update();
+    thresh->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  frames.push_back(reader->GetOutput());
+  frames.push_back(thresh->GetOutput());
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetUseImageSpacing(true);
+  filter->SetScale(2.0);
+  filter->SetNumberOfWorkUnits(3);
+  filter->SetSmallImageThreshold(0);
+  filter->ReleaseDataBeforeUpdateFlagOff();
+
+  const PType * buffer = nullptr;
+  try
+  {
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+      filter->SetInput(frames[i % frames.size()]);
+      filter->Update();
+      if (i == 0)
+      {
+        buffer = filter->GetOutput()->GetBufferPointer();
+      }
+      else if (buffer != filter->GetOutput()->GetBufferPointer())
+      {
+        std::cerr << "Output buffer reallocated for frame " << i << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FilterType::Pointer fresh = FilterType::New();
+  fresh->SetInput(frames[0]);
+  fresh->SetUseImageSpacing(true);
+  fresh->SetScale(2.0);
+
+  writer->SetInput(fresh->GetOutput());
+  writer->SetFileName(argv[3]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
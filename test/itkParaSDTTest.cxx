@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "itkMorphologicalSignedDistanceTransformImageFilter.h"
+
+// Signed distance transform of a disc and a square, with either sign
+// inside, against a brute force distance to the other side of the
+// edge.
+
+int
+itkParaSDTTest(int, char *[])
+{
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  IType::SizeType size;
+  size[0] = 48;
+  size[1] = 40;
+  IType::Pointer mask = IType::New();
+  mask->SetRegions(size);
+  mask->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<IType> maskIt(mask, mask->GetBufferedRegion());
+  for (; !maskIt.IsAtEnd(); ++maskIt)
+  {
+    const IType::IndexType idx = maskIt.GetIndex();
+    const bool             disc = (idx[0] - 15) * (idx[0] - 15) + (idx[1] - 18) * (idx[1] - 18) < 100;
+    const bool             square = idx[0] >= 32 && idx[0] < 42 && idx[1] >= 5 && idx[1] < 30;
+    maskIt.Set((disc || square) ? 1 : 0);
+  }
+
+  using FilterType = itk::MorphologicalSignedDistanceTransformImageFilter<IType, FType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(mask);
+  filter->SetOutsideValue(0);
+
+  for (const bool insideIsPositive : { false, true, false })
+  {
+    filter->SetInsideIsPositive(insideIsPositive);
+    try
+    {
+      filter->Update();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    itk::ImageRegionConstIteratorWithIndex<FType> it(filter->GetOutput(), filter->GetOutput()->GetBufferedRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      // distance to the nearest pixel on the other side of the edge
+      const PType value = mask->GetPixel(it.GetIndex());
+      double      d2 = itk::NumericTraits<double>::max();
+      itk::ImageRegionConstIteratorWithIndex<IType> other(mask, mask->GetBufferedRegion());
+      for (; !other.IsAtEnd(); ++other)
+      {
+        if (other.Get() != value)
+        {
+          const double dx = static_cast<double>(it.GetIndex()[0] - other.GetIndex()[0]);
+          const double dy = static_cast<double>(it.GetIndex()[1] - other.GetIndex()[1]);
+          d2 = std::min(d2, dx * dx + dy * dy);
+        }
+      }
+      const bool   positive = (value == 0) != insideIsPositive;
+      const double expected = positive ? std::sqrt(d2) : -std::sqrt(d2);
+      if (std::abs(it.Get() - expected) > 1e-3)
+      {
+        std::cerr << "Distance at " << it.GetIndex() << " is " << it.Get() << ", expected " << expected
+                  << " with InsideIsPositive " << insideIsPositive << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // The contact point algorithm must agree. The lines it works on hold
+  // distances far outside the range of the mask pixel type.
+  FilterType::Pointer contact = FilterType::New();
+  contact->SetInput(mask);
+  contact->SetOutsideValue(0);
+  contact->SetInsideIsPositive(filter->GetInsideIsPositive());
+  contact->SetParabolicAlgorithm(FilterType::CONTACTPOINT);
+  try
+  {
+    contact->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+  itk::ImageRegionConstIteratorWithIndex<FType> it(filter->GetOutput(), filter->GetOutput()->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const float value = contact->GetOutput()->GetPixel(it.GetIndex());
+    if (std::abs(value - it.Get()) > 1e-3)
+    {
+      std::cerr << "Contact point distance at " << it.GetIndex() << " is " << value << ", intersection gives "
+                << it.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCastImageFilter.h"
+#include "itkConstantPadImageFilter.h"
+#include "itkCropImageFilter.h"
+#include "itkStatisticsImageFilter.h"
+
+#include "itkParabolicCloseImageFilter.h"
+#include "itkParabolicOpenCloseImageFilter.h"
+
+// The safe border is sized from the values near each side of the
+// image. A dark strip along one side must shrink the border there
+// below the width the whole range of the image calls for, and the
+// closing must match one padded by that width on every side.
+
+int
+itkParaSafeBorderTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage safeBorder globalPad" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using CastType = itk::CastImageFilter<IType, FType>;
+  CastType::Pointer cast = CastType::New();
+  cast->SetInput(reader->GetOutput());
+
+  using StatsType = itk::StatisticsImageFilter<FType>;
+  StatsType::Pointer stats = StatsType::New();
+  stats->SetInput(cast->GetOutput());
+  try
+  {
+    stats->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr double scale = 5.0;
+
+  // the border for the whole range
+  const double range = stats->GetMaximum() - stats->GetMinimum();
+  FType::SizeType pad;
+  pad.Fill(static_cast<itk::SizeValueType>(std::ceil(std::sqrt(2 * scale * range))));
+
+  // a strip of the minimum along the lower x side, wider than the band
+  // the border there is sized from, so that the closing needs no
+  // border on that side
+  using PadType = itk::ConstantPadImageFilter<FType, FType>;
+  FType::SizeType strip;
+  strip.Fill(0);
+  strip[0] = 2 * pad[0];
+  FType::SizeType none;
+  none.Fill(0);
+  PadType::Pointer darken = PadType::New();
+  darken->SetInput(cast->GetOutput());
+  darken->SetPadLowerBound(strip);
+  darken->SetPadUpperBound(none);
+  darken->SetConstant(stats->GetMinimum());
+
+  using CloseType = itk::ParabolicCloseImageFilter<FType, FType>;
+  CloseType::Pointer close = CloseType::New();
+  close->SetInput(darken->GetOutput());
+  close->SetScale(scale);
+  close->SetSafeBorder(true);
+
+  PadType::Pointer padFilter = PadType::New();
+  padFilter->SetInput(darken->GetOutput());
+  padFilter->SetPadLowerBound(pad);
+  padFilter->SetPadUpperBound(pad);
+  padFilter->SetConstant(stats->GetMinimum());
+
+  using OpenCloseType = itk::ParabolicOpenCloseImageFilter<FType, false, FType>;
+  OpenCloseType::Pointer padded = OpenCloseType::New();
+  padded->SetInput(padFilter->GetOutput());
+  padded->SetScale(scale);
+
+  using CropType = itk::CropImageFilter<FType, FType>;
+  CropType::Pointer crop = CropType::New();
+  crop->SetInput(padded->GetOutput());
+  crop->SetLowerBoundaryCropSize(pad);
+  crop->SetUpperBoundaryCropSize(pad);
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  WriterType::Pointer writer = WriterType::New();
+  try
+  {
+    writer->SetInput(close->GetOutput());
+    writer->SetFileName(argv[2]);
+    writer->Update();
+    writer->SetInput(crop->GetOutput());
+    writer->SetFileName(argv[3]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const FType::SizeType lower = close->GetBorderPadLowerBoundUsed();
+  const FType::SizeType upper = close->GetBorderPadUpperBoundUsed();
+  std::cout << "Border below " << lower << " above " << upper << ", global pad " << pad << std::endl;
+  for (unsigned int d = 0; d < dim; ++d)
+  {
+    if (lower[d] > pad[d] || upper[d] > pad[d])
+    {
+      std::cerr << "Border wider than the global pad along " << d << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (lower[0] >= pad[0])
+  {
+    std::cerr << "Border beside the dark strip is not narrower than the global pad" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
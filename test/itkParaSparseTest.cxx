@@ -0,0 +1,98 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include "itkMorphologicalDistanceTransformImageFilter.h"
+
+// Distance transform of a few seeds in an otherwise empty volume,
+// where almost every line is all one value, against a brute force
+// squared distance.
+
+int
+itkParaSparseTest(int, char *[])
+{
+  constexpr int dim = 3;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  IType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  size[2] = 40;
+  IType::Pointer mask = IType::New();
+  mask->SetRegions(size);
+  mask->Allocate();
+  mask->FillBuffer(0);
+
+  std::vector<IType::IndexType> seeds(3);
+  seeds[0][0] = 5;
+  seeds[0][1] = 7;
+  seeds[0][2] = 3;
+  seeds[1][0] = 40;
+  seeds[1][1] = 30;
+  seeds[1][2] = 20;
+  seeds[2][0] = 63;
+  seeds[2][1] = 0;
+  seeds[2][2] = 39;
+  for (const auto & seed : seeds)
+  {
+    mask->SetPixel(seed, 1);
+  }
+
+  using FilterType = itk::MorphologicalDistanceTransformImageFilter<IType, FType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(mask);
+  filter->SetOutsideValue(1);
+  filter->SetUseImageSpacing(false);
+  filter->SqrDistOn();
+  try
+  {
+    filter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  itk::ImageRegionConstIteratorWithIndex<FType> it(filter->GetOutput(), filter->GetOutput()->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    double expected = itk::NumericTraits<double>::max();
+    for (const auto & seed : seeds)
+    {
+      double d2 = 0;
+      for (unsigned int d = 0; d < dim; ++d)
+      {
+        const double diff = static_cast<double>(it.GetIndex()[d] - seed[d]);
+        d2 += diff * diff;
+      }
+      expected = std::min(expected, d2);
+    }
+    if (std::abs(it.Get() - expected) > 1e-3)
+    {
+      std::cerr << "Distance at " << it.GetIndex() << " is " << it.Get() << ", expected " << expected << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
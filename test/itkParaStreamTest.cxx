@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionSplitterDirection.h"
+
+#include "itkParabolicErodeImageFilter.h"
+
+// Out of core processing in two streamed stages. The first processes
+// x, streaming across y, and the second processes y, streaming across
+// x. With file based readers and writers in place of the
+// StreamingImageFilter, only one piece of each stage is in memory at a
+// time. The result must match a single filter on the whole image.
+
+int
+itkParaStreamTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage streamedOutput wholeOutput" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  using StreamerType = itk::StreamingImageFilter<IType, IType>;
+  constexpr double       scale = 2.0;
+  constexpr unsigned int pieces = 4;
+
+  // stage 1 - x direction, streamed across y (the default splitter
+  // splits the slowest direction)
+  FilterType::RadiusType stageScale;
+  stageScale[0] = scale;
+  stageScale[1] = 0;
+  FilterType::Pointer stage1 = FilterType::New();
+  stage1->SetInput(reader->GetOutput());
+  stage1->SetUseImageSpacing(true);
+  stage1->SetScale(stageScale);
+
+  StreamerType::Pointer streamer1 = StreamerType::New();
+  streamer1->SetInput(stage1->GetOutput());
+  streamer1->SetNumberOfStreamDivisions(pieces);
+
+  // stage 2 - y direction, streamed across x
+  stageScale[0] = 0;
+  stageScale[1] = scale;
+  FilterType::Pointer stage2 = FilterType::New();
+  stage2->SetInput(streamer1->GetOutput());
+  stage2->SetUseImageSpacing(true);
+  stage2->SetScale(stageScale);
+
+  using SplitterType = itk::ImageRegionSplitterDirection;
+  SplitterType::Pointer splitter = SplitterType::New();
+  splitter->SetDirection(1);
+
+  StreamerType::Pointer streamer2 = StreamerType::New();
+  streamer2->SetInput(stage2->GetOutput());
+  streamer2->SetNumberOfStreamDivisions(pieces);
+  streamer2->SetRegionSplitter(splitter);
+
+  try
+  {
+    streamer2->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // each stage should only have produced a piece at a time
+  const IType::SizeType wholeSize = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+  if (stage1->GetOutput()->GetBufferedRegion().GetSize()[1] >= wholeSize[1] ||
+      stage2->GetOutput()->GetBufferedRegion().GetSize()[0] >= wholeSize[0])
+  {
+    std::cerr << "Stages were not streamed: " << stage1->GetOutput()->GetBufferedRegion() << " "
+              << stage2->GetOutput()->GetBufferedRegion() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(streamer2->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FilterType::Pointer whole = FilterType::New();
+  whole->SetInput(reader->GetOutput());
+  whole->SetUseImageSpacing(true);
+  whole->SetScale(scale);
+
+  writer->SetInput(whole->GetOutput());
+  writer->SetFileName(argv[3]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
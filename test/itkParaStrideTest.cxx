@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "itkParabolicErodeImageFilter.h"
+
+// Erode with an output stride, and check the result against a full
+// erosion subsampled afterwards, for both algorithms and for a strided
+// direction with a zero scale.
+
+int
+itkParaStrideTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage stridedOutput subsampledOutput" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::StrideType stride;
+  stride[0] = 2;
+  stride[1] = 3;
+
+  struct Config
+  {
+    int    algorithm;
+    double scaleY;
+  };
+  const Config configs[] = { { FilterType::INTERSECTION, 2.0 },
+                             { FilterType::CONTACTPOINT, 2.0 },
+                             { FilterType::INTERSECTION, 0.0 } };
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  for (const Config & config : configs)
+  {
+    FilterType::RadiusType scale;
+    scale[0] = 1.0;
+    scale[1] = config.scaleY;
+
+    FilterType::Pointer full = FilterType::New();
+    full->SetInput(reader->GetOutput());
+    full->SetScale(scale);
+    full->SetParabolicAlgorithm(config.algorithm);
+
+    FilterType::Pointer strided = FilterType::New();
+    strided->SetInput(reader->GetOutput());
+    strided->SetScale(scale);
+    strided->SetParabolicAlgorithm(config.algorithm);
+    strided->SetOutputStride(stride);
+    try
+    {
+      full->Update();
+      strided->Update();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const IType * result = strided->GetOutput();
+    const IType * reference = full->GetOutput();
+    for (unsigned int d = 0; d < dim; ++d)
+    {
+      const itk::SizeValueType length = reference->GetLargestPossibleRegion().GetSize(d);
+      const itk::SizeValueType expected = (length + stride[d] - 1) / stride[d];
+      if (result->GetLargestPossibleRegion().GetSize(d) != expected ||
+          itk::Math::NotAlmostEquals(result->GetSpacing()[d], reference->GetSpacing()[d] * stride[d]))
+      {
+        std::cerr << "Wrong geometry along " << d << ": " << result->GetLargestPossibleRegion() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // the subsampled full erosion, on the strided geometry
+    IType::Pointer subsampled = IType::New();
+    subsampled->CopyInformation(result);
+    subsampled->SetRegions(result->GetLargestPossibleRegion());
+    subsampled->Allocate();
+    const IType::IndexType start = result->GetLargestPossibleRegion().GetIndex();
+    unsigned int           mismatches = 0;
+    for (itk::ImageRegionIteratorWithIndex<IType> it(subsampled, subsampled->GetLargestPossibleRegion()); !it.IsAtEnd();
+         ++it)
+    {
+      IType::IndexType source = it.GetIndex();
+      for (unsigned int d = 0; d < dim; ++d)
+      {
+        source[d] = start[d] + (source[d] - start[d]) * stride[d];
+      }
+      it.Set(reference->GetPixel(source));
+      mismatches += it.Get() != result->GetPixel(it.GetIndex());
+    }
+    if (mismatches > 0)
+    {
+      std::cerr << mismatches << " pixels differ from the subsampled erosion, algorithm " << config.algorithm
+                << ", y scale " << config.scaleY << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (&config == &configs[0])
+    {
+      try
+      {
+        writer->SetInput(result);
+        writer->SetFileName(argv[2]);
+        writer->Update();
+        writer->SetInput(subsampled);
+        writer->SetFileName(argv[3]);
+        writer->Update();
+      }
+      catch (itk::ExceptionObject & excp)
+      {
+        std::cerr << excp << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
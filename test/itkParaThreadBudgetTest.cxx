@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <algorithm>
+#include <iomanip>
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkPlatformMultiThreader.h"
+
+#include "itkMorphologicalSignedDistanceTransformImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+
+// Give composite filters a threader that records the work units it is
+// asked for, and a budget of one work unit. The internal stages must
+// run on that threader, within that budget.
+
+namespace
+{
+class RecordingMultiThreader : public itk::PlatformMultiThreader
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(RecordingMultiThreader);
+
+  using Self = RecordingMultiThreader;
+  using Superclass = itk::PlatformMultiThreader;
+  using Pointer = itk::SmartPointer<Self>;
+
+  itkNewMacro(Self);
+
+  void
+  SetNumberOfWorkUnits(itk::ThreadIdType numberOfWorkUnits) override
+  {
+    ++m_Calls;
+    m_Largest = std::max(m_Largest, numberOfWorkUnits);
+    Superclass::SetNumberOfWorkUnits(numberOfWorkUnits);
+  }
+
+  unsigned int      m_Calls{ 0 };
+  itk::ThreadIdType m_Largest{ 0 };
+
+protected:
+  RecordingMultiThreader() = default;
+  ~RecordingMultiThreader() override = default;
+};
+
+template <typename TFilter>
+bool
+RunsWithinBudget(TFilter * filter, const char * name)
+{
+  RecordingMultiThreader::Pointer threader = RecordingMultiThreader::New();
+  filter->SetMultiThreader(threader);
+  filter->SetNumberOfWorkUnits(1);
+  threader->m_Calls = 0;
+  threader->m_Largest = 0;
+  try
+  {
+    filter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return false;
+  }
+  std::cout << name << ": " << threader->m_Calls << " stages, at most " << threader->m_Largest << " work units"
+            << std::endl;
+  if (threader->m_Calls == 0 || threader->m_Largest != 1)
+  {
+    std::cerr << name << " internal stages did not share the budget of one work unit" << std::endl;
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+int
+itkParaThreadBudgetTest(int, char *[])
+{
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  IType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  IType::Pointer mask = IType::New();
+  mask->SetRegions(size);
+  mask->Allocate();
+  FType::Pointer image = FType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  for (itk::ImageRegionIteratorWithIndex<IType> it(mask, mask->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    const IType::IndexType idx = it.GetIndex();
+    const bool             disc = (idx[0] - 30) * (idx[0] - 30) + (idx[1] - 20) * (idx[1] - 20) < 150;
+    it.Set(disc ? 1 : 0);
+    image->SetPixel(idx, static_cast<float>((idx[0] * 7 + idx[1] * 13) % 50));
+  }
+
+  using SDTType = itk::MorphologicalSignedDistanceTransformImageFilter<IType, FType>;
+  SDTType::Pointer sdt = SDTType::New();
+  sdt->SetInput(mask);
+  sdt->SetOutsideValue(0);
+
+  using OpenType = itk::ParabolicOpenImageFilter<FType, FType>;
+  OpenType::Pointer open = OpenType::New();
+  open->SetInput(image);
+  open->SetScale(2.0);
+  open->SafeBorderOn();
+
+  if (!RunsWithinBudget(sdt.GetPointer(), "Signed distance transform") ||
+      !RunsWithinBudget(open.GetPointer(), "Safe border opening"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}